@@ -14,6 +14,9 @@
 #define TYPES_HPP
 
 #include "Webserv.hpp"
+#include "src/RequestParser/RequestHeaders.hpp"
+
+class RequestBody;
 
 struct ClientRequest {
 	// Request line
@@ -24,12 +27,12 @@ struct ClientRequest {
 	std::string version;
 
 	// Headers
-	std::map<std::string, std::string> headers;
+	RequestHeaders headers;
 	bool chunked_encoding;
 	bool file_upload;
 
-	// Body (optional)
-	std::string body;
+	// Body (optional), received by the connection: the parser only checks its size
+	const RequestBody *body;
 
 	// Client FD
 	int clfd;
@@ -37,6 +40,12 @@ struct ClientRequest {
 	// CGI request
 	std::string extension;
 
+	ClientRequest()
+	    : chunked_encoding(false),
+	      file_upload(false),
+	      body(NULL),
+	      clfd(-1) {}
+
 	std::string toString();
 };
 
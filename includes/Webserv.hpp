@@ -23,20 +23,27 @@
 #include <cstdlib> // for exit
 #include <cstring> // for strncmp
 #include <ctime>
+#include <deque>
 #include <dirent.h> // for directory listing
 #include <exception>
 #include <fcntl.h>
 #include <fstream> // for ifstream
 #include <functional>
 #include <iostream>
+#include <list>
 #include <map> // for map
 #include <netdb.h>
 #include <netinet/in.h>
+#include <pthread.h>
 #include <signal.h>
+#include <set>
 #include <sstream>
 #include <stdint.h> // for uint16_t
 #include <string>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
 #include <sys/socket.h> // for send
 #include <sys/stat.h>
 #include <sys/types.h> // for pid_t
@@ -45,8 +52,8 @@
 #include <utility>     // for makepair
 #include <vector>      // for vector
 
-// Global error status variable
-extern uint16_t g_error_status;
+// Error status of the request being handled (one per event-loop thread)
+extern __thread uint16_t g_error_status;
 
 #define CHUNK_SIZE 500
 
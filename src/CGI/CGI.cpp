@@ -11,16 +11,19 @@
 /* ************************************************************************** */
 
 #include "CGI.hpp"
+#include "src/HttpServer/Structs/RequestBody.hpp"
 
-CGI::CGI(ClientRequest &request, LocConfig *locConfig)
-    : script_path_(locConfig->getFullPath()) {
-	setEnv("SCRIPT_FILENAME", locConfig->getFullPath());
+CGI::CGI(ClientRequest &request, const LocConfig *locConfig, const std::string &script_path)
+    : script_path_(script_path) {
+	setEnv("SCRIPT_FILENAME", script_path);
 	setEnv("SCRIPT_NAME", "/" + request.path);
 	setEnv("REQUEST_METHOD", request.method);
 	setEnv("QUERY_STRING", request.query);
 	if (request.method == "POST") {
-		setEnv("CONTENT_TYPE", request.headers["content-type"]);
-		setEnv("CONTENT_LENGTH", request.headers["content-length"]);
+		setEnv("CONTENT_TYPE", request.headers.value(RequestHeaders::CONTENT_TYPE));
+		// The size received: a chunked request has no Content-Length
+		setEnv("CONTENT_LENGTH", request.body ? su::to_string(request.body->size())
+		                                      : request.headers.value(RequestHeaders::CONTENT_LENGTH));
 	}
 	if (request.method == "POST" || request.method == "DELETE")
 		setEnv("UPLOAD_DIR", "../.." + locConfig->getUploadPath());
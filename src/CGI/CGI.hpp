@@ -28,7 +28,7 @@ class CGI {
 	pid_t pid_;
 
   public:
-	CGI(ClientRequest &request, LocConfig *locConfig);
+	CGI(ClientRequest &request, const LocConfig *locConfig, const std::string &script_path);
 	~CGI(){};
 
 	// ENV
@@ -61,7 +61,7 @@ class CGI {
 
 namespace CGIUtils {
 bool runCGIScript(ClientRequest &req, CGI &cgi);
-CGI *createCGI(ClientRequest &req, LocConfig *locConfig);
+CGI *createCGI(ClientRequest &req, const LocConfig *locConfig, const std::string &script_path);
 } // namespace CGIUtils
 
 #endif
@@ -11,6 +11,7 @@
 /* ************************************************************************** */
 
 #include "CGI.hpp"
+#include "src/HttpServer/Structs/RequestBody.hpp"
 
 bool CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 	Logger logger;
@@ -22,6 +23,16 @@ bool CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 		return (false);
 	}
 
+	// A body that went to a temporary file is the stdin of the script itself,
+	// one in memory is written to the input pipe
+	const RequestBody *body = (req.method == "POST") ? req.body : NULL;
+	int body_fd = -1;
+	if (body && body->inFile() && (body_fd = body->file()) == -1) {
+		logger.logWithPrefix(Logger::ERROR, "CGI", "Failed to rewind the request body");
+		cgi.freeEnvp(envp);
+		return (false);
+	}
+
 	// 3. Create pipes with error checking
 	int input_pipe[2], output_pipe[2];
 	if (pipe(input_pipe) == -1) {
@@ -54,7 +65,8 @@ bool CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 
 	if (pid == 0) {
 		// Child process
-		if (dup2(input_pipe[0], STDIN_FILENO) == -1 || dup2(output_pipe[1], STDOUT_FILENO) == -1)
+		int stdin_fd = (body_fd != -1) ? body_fd : input_pipe[0];
+		if (dup2(stdin_fd, STDIN_FILENO) == -1 || dup2(output_pipe[1], STDOUT_FILENO) == -1)
 			exit(1);
 
 		// Close unused pipe ends
@@ -80,12 +92,16 @@ bool CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 
 	usleep(10000); // 10ms delay to let execve complete or fail
 
-	// Check if execve failed
-	int status;
-	pid_t wait_result = waitpid(pid, &status, WNOHANG);
-	if (wait_result > 0) {
-		// Child exited immediately - execve likely failed
+	// Check if execve failed. The child is not reaped: a script that already
+	// succeeded (its body was in a file) left its output in the pipe.
+	siginfo_t info;
+	info.si_pid = 0;
+	int wait_result = waitid(P_PID, pid, &info, WEXITED | WNOHANG | WNOWAIT);
+	if (wait_result == 0 && info.si_pid == pid &&
+	    !(info.si_code == CLD_EXITED && info.si_status == 0)) {
+		// Child failed immediately - execve likely failed
 		logger.logWithPrefix(Logger::ERROR, "CGI", "CGI script failed to execute");
+		waitpid(pid, NULL, 0);
 		close(input_pipe[1]);
 		close(output_pipe[0]);
 		return (false);
@@ -97,29 +113,35 @@ bool CGIUtils::runCGIScript(ClientRequest &req, CGI &cgi) {
 		return (false);
 	}
 
-	// 6. Send POST data if any
-	if (req.method == "POST") {
+	// 6. Send POST data if any. It is at most PIPE_BUF (RequestBody::MAX_MEMORY_LIMIT),
+	// which even the smallest pipe takes at once: the write never blocks. A script
+	// that is already done does not read it, writing would raise SIGPIPE.
+	bool exited = wait_result == 0 && info.si_pid == pid;
+	if (body && !body->inFile() && !body->empty() && !exited) {
 		logger.logWithPrefix(Logger::INFO, "CGI", "Handling POST request");
-		if (!req.body.empty()) {
-			size_t total_written = 0;
-			while (total_written < req.body.size()) {
-				ssize_t written = write(input_pipe[1], req.body.c_str() + total_written,
-				                        req.body.size() - total_written);
-				if (written <= 0) {
-					logger.logWithPrefix(Logger::WARNING, "CGI",
-					                     "Failed to write request body to CGI script");
-					close(input_pipe[1]);
-					return (false);
-				};
-				total_written += written;
-			}
+		const std::string &data = body->memory();
+		size_t total_written = 0;
+		while (total_written < data.size()) {
+			ssize_t written =
+			    write(input_pipe[1], data.data() + total_written, data.size() - total_written);
+			if (written <= 0) {
+				logger.logWithPrefix(Logger::WARNING, "CGI",
+				                     "Failed to write request body to CGI script");
+				kill(pid, SIGKILL);
+				waitpid(pid, NULL, 0);
+				close(input_pipe[1]);
+				close(output_pipe[0]);
+				return (false);
+			};
+			total_written += written;
 		}
 	}
 	close(input_pipe[1]);
 	return (true);
 }
 
-CGI *CGIUtils::createCGI(ClientRequest &req, LocConfig *locConfig) {
+CGI *CGIUtils::createCGI(ClientRequest &req, const LocConfig *locConfig,
+                          const std::string &script_path) {
 	Logger logger;
 	// 1. Validate and construct script path
 	if (req.path.empty() || req.path.find("..") != std::string::npos) {
@@ -128,7 +150,7 @@ CGI *CGIUtils::createCGI(ClientRequest &req, LocConfig *locConfig) {
 	}
 
 	// Heap allocated
-	CGI *cgi = new CGI(req, locConfig);
+	CGI *cgi = new CGI(req, locConfig, script_path);
 	if (!runCGIScript(req, *cgi))
 		return (NULL);
 
@@ -13,6 +13,12 @@
 #include "ConfigParser.hpp"
 
 bool ConfigParser::loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers) {
+	GlobalConfig global;
+	return loadConfig(filePath, servers, global);
+}
+
+bool ConfigParser::loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers,
+                              GlobalConfig &global) {
 
 	ConfigNode tree;
 	ConfigParser configparser;
@@ -20,7 +26,7 @@ bool ConfigParser::loadConfig(const std::string &filePath, std::vector<ServerCon
 	if (!configparser.parseTree(filePath, tree))
 		return false;
 
-	if (!configparser.convertTreeToStruct(tree, servers))
+	if (!configparser.convertTreeToStruct(tree, servers, global))
 		return false;
 
 	return true;
@@ -14,6 +14,7 @@
 #define CONFIG__PARSER_HPP
 
 #include "includes/Webserv.hpp"
+#include "src/ConfigParser/LocationTrie.hpp"
 #include "src/Logger/Logger.hpp"
 #include "src/Utils/StringUtils.hpp"
 
@@ -21,9 +22,16 @@
 #define SIZE_MAX ((size_t)-1)
 #endif
 
+#define MAX_WORKER_PROCESSES 256
+#define MAX_WORKER_THREADS 256
+#define MAX_TIMEOUT 86400 // seconds
+#define MAX_ACCEPT_BATCH 1024
+#define MAX_OPEN_FILE_CACHE 65536
+
 extern const int http_status_codes[];
 
 class ConfigNode;
+class GlobalConfig;
 class ServerConfig;
 class LocConfig;
 class WebServer;
@@ -55,6 +63,8 @@ class ConfigParser {
 
 	// PARSING THE CONFIGURATION FILE
 	bool loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers);
+	bool loadConfig(const std::string &filePath, std::vector<ServerConfig> &servers,
+	                GlobalConfig &global);
 
   private:
 	Logger logg_;
@@ -74,23 +84,31 @@ class ConfigParser {
 	bool isDirective(const std::string &line) const;
 
 	// tree to Struct
-	bool convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers);
+	bool convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers,
+	                         GlobalConfig &global);
 	/* void serverStructure(const ConfigNode &tree, std::vector<ServerConfig> &servers);
 	void treeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers); */
 
 	// utils for the struct
+	void handleWorkers(const ConfigNode &node, GlobalConfig &global);
+	void handleThreads(const ConfigNode &node, GlobalConfig &global);
+	void handleOpenFileCache(const ConfigNode &node, GlobalConfig &global);
 	void handleListen(const ConfigNode &node, ServerConfig &server);
 	void handleRoot(const ConfigNode &node, LocConfig &location);
 	void handleIndex(const ConfigNode &node, LocConfig &location);
 	void handleErrorPage(const ConfigNode &node, ServerConfig &server);
 	void handleBodySize(const ConfigNode &node, ServerConfig &server);
+	void handleTimeout(const ConfigNode &node, ServerConfig &server);
+	void handleAcceptBatch(const ConfigNode &node, ServerConfig &server);
 	void handleLocationBlock(const ConfigNode &locNode, LocConfig &location);
 	void handleReturn(const ConfigNode &node, LocConfig &location);
 	void handleCGI(const ConfigNode &node, LocConfig &location);
 	void handleForInherit(const ConfigNode &node, LocConfig &location);
 	void inheritGeneralConfig(ServerConfig &server, const LocConfig &forInheritance);
-	void sortLocations(std::vector<LocConfig> &locations);
+	void sortLocations(ServerConfig &server);
 	static bool compareLocationPaths(const LocConfig &a, const LocConfig &b);
+	static size_t parseSize(const std::string &value);
+	static long parseTime(const std::string &value);
 	bool isDuplicateServer(const std::vector<ServerConfig> &servers, const ServerConfig &newServer);
 	bool existentLocationDuplicate(const ServerConfig &server, const LocConfig &location);
 	bool baseLocation(ServerConfig &server);
@@ -103,13 +121,20 @@ class ConfigParser {
 	bool validateReturn(const ConfigNode &node);
 	bool validateMethod(const ConfigNode &node);
 	bool validateMaxBody(const ConfigNode &node);
-	bool validateAutoIndex(const ConfigNode &node);
+	bool validateOnOff(const ConfigNode &node);
 	bool validateLocation(const ConfigNode &node);
 	bool validateCGI(const ConfigNode &node);
 	bool validateChunk(const ConfigNode &node);
 	bool validateUploadPath(const ConfigNode &node);
 	bool validateRoot(const ConfigNode &node);
 	bool validateIndex(const ConfigNode &node);
+	bool validateWorkers(const ConfigNode &node);
+	bool validateThreads(const ConfigNode &node);
+	bool validateTimeout(const ConfigNode &node);
+	bool validateAcceptBatch(const ConfigNode &node);
+	bool validateOpenFileCache(const ConfigNode &node);
+	bool validateMmapBand(const ConfigNode &node);
+	bool validateCompLevel(const ConfigNode &node);
 
 	// utils for validity
 	void initValidDirectives();
@@ -147,14 +172,76 @@ class ConfigNode {
 	      line_(line) {}
 };
 
+/// Settings that apply to the whole process rather than to a single server block.
+/// Set from the main/http context of the configuration file; some can be overridden
+/// from the command line.
+class GlobalConfig {
+	friend class ConfigParser;
+
+  private:
+	int worker_processes;           // 1 = single process, no master
+	int worker_threads;             // event-loop threads per process, 1 = serve from the main thread
+	bool edge_triggered;            // register client sockets with EPOLLET and drain them until EAGAIN
+	size_t open_file_cache;         // cached paths per event loop, 0 = off
+	int open_file_cache_valid;      // seconds a cached path is trusted without a stat()
+	size_t static_cache_max_bytes;  // small-file responses kept in memory per event loop, 0 = off
+	size_t static_cache_max_file;   // largest file whose response is kept in memory
+	size_t static_mmap_min;         // files of this size ...
+	size_t static_mmap_max;         // ... up to this one are sent from a mapping, 0 = off
+	bool gzip;                      // compress text-like static files on the fly
+	bool gzip_static;               // send file.br / file.gz instead of file when accepted
+	int gzip_comp_level;            // zlib level, 1 (fastest) to 9 (smallest)
+	size_t gzip_min_length;         // smaller files are not compressed on the fly
+	size_t client_body_buffer_size; // larger request bodies are moved to a temporary file
+
+  public:
+	GlobalConfig()
+	    : worker_processes(1),
+	      worker_threads(1),
+	      edge_triggered(false),
+	      open_file_cache(256),
+	      open_file_cache_valid(2),
+	      static_cache_max_bytes(0),
+	      static_cache_max_file(64 * 1024),
+	      static_mmap_min(0),
+	      static_mmap_max(0),
+	      gzip(false),
+	      gzip_static(false),
+	      gzip_comp_level(1),
+	      gzip_min_length(20),
+	      client_body_buffer_size(PIPE_BUF) {}
+
+	inline int getWorkerProcesses() const { return worker_processes; }
+	inline void setWorkerProcesses(int n) {
+		worker_processes = std::max(1, std::min(n, MAX_WORKER_PROCESSES));
+	}
+	inline int getWorkerThreads() const { return worker_threads; }
+	inline void setWorkerThreads(int n) {
+		worker_threads = std::max(1, std::min(n, MAX_WORKER_THREADS));
+	}
+	inline bool isEdgeTriggered() const { return edge_triggered; }
+	inline void setEdgeTriggered(bool on) { edge_triggered = on; }
+	inline size_t getOpenFileCache() const { return open_file_cache; }
+	inline int getOpenFileCacheValid() const { return open_file_cache_valid; }
+	inline size_t getStaticCacheMaxBytes() const { return static_cache_max_bytes; }
+	inline size_t getStaticCacheMaxFile() const { return static_cache_max_file; }
+	inline bool isMmapSize(off_t size) const {
+		return static_mmap_max > 0 && static_cast<size_t>(size) >= static_mmap_min &&
+		       static_cast<size_t>(size) <= static_mmap_max;
+	}
+	inline bool isGzip() const { return gzip; }
+	inline bool isGzipStatic() const { return gzip_static; }
+	inline int getGzipCompLevel() const { return gzip_comp_level; }
+	inline size_t getGzipMinLength() const { return gzip_min_length; }
+	inline size_t getClientBodyBufferSize() const { return client_body_buffer_size; }
+};
+
 class LocConfig {
 	friend class ConfigParser;
 	friend class WebServer;
 
   private:
 	std::string path;
-	bool exact_match;
-	std::string full_path;
 	std::vector<std::string> allowed_methods;
 	uint16_t return_code;
 	std::string return_target;
@@ -166,16 +253,11 @@ class LocConfig {
 
   public:
 	LocConfig()
-	    : exact_match(0),
-		  return_code(0),
+	    : return_code(0),
 	      autoindex(false) {}
 
 	inline std::string getPath() const { return path; }
-	inline bool is_exact_() const { return exact_match; }
 	inline std::string getRoot() const { return path; }
-	inline std::string getFullPath() const { return full_path; }
-	inline void setFullPath(const std::string &path) { full_path = path; }
-	inline void setExact(bool is_exact) {exact_match = is_exact; }
 
 	inline std::string getUploadPath() const { return upload_path; }
 
@@ -192,7 +274,7 @@ class LocConfig {
 		return false;
 	}
 
-	std::string getAllowedMethodsString() {
+	std::string getAllowedMethodsString() const {
 		std::string allowed;
 		for (size_t i = 0; i < allowed_methods.size(); ++i) {
 			allowed += allowed_methods[i];
@@ -221,21 +303,43 @@ class LocConfig {
 class ServerConfig {
 	friend class ConfigParser;
 
+  public:
+	/// A ready error page body, see WebServer::loadErrorPages().
+	struct ErrorBody {
+		std::string body;
+		std::string content_type;
+	};
+
   private:
 	std::string host;
 	int port;
 	std::map<uint16_t, std::string> error_pages;
+	std::map<uint16_t, ErrorBody> error_bodies; // loaded once at startup, read-only afterwards
 	size_t client_max_body_size;
 	std::vector<LocConfig> locations;
+	LocationTrie location_trie; // paths of locations, built by ConfigParser::sortLocations
 
-	std::string root_prefix; // can be removed probably
+	// Timeouts, in seconds
+	int client_header_timeout; // whole request line + headers
+	int client_body_timeout;   // between two reads of the body
+	int keepalive_timeout;     // idle between two requests
+	int send_timeout;          // between two writes of the response
+
+	int accept_batch; // connections accepted per listener wakeup
+
+	std::string root_prefix; // --prefix-path, prepended to error page paths
 	int server_fd;
 
   public:
 	ServerConfig()
 	    : host("0.0.0.0"),
 	      port(8080),
-	      client_max_body_size(1048576) {}
+	      client_max_body_size(1048576),
+	      client_header_timeout(60),
+	      client_body_timeout(60),
+	      keepalive_timeout(75),
+	      send_timeout(60),
+	      accept_batch(64) {}
 
 	// GETTERS
 	inline const std::string &getHost() const { return host; }
@@ -248,11 +352,26 @@ class ServerConfig {
 	inline size_t getMaxBodySize() const { return client_max_body_size; }
 	inline bool hasErrorPage(uint16_t status) const { return error_pages.find(status) != error_pages.end();	}
 	inline bool infiniteBodySize() const { return (client_max_body_size == 0) ? true : false; }
+	inline int getHeaderTimeout() const { return client_header_timeout; }
+	inline int getBodyTimeout() const { return client_body_timeout; }
+	inline int getKeepaliveTimeout() const { return keepalive_timeout; }
+	inline int getSendTimeout() const { return send_timeout; }
+	inline int getAcceptBatch() const { return accept_batch; }
 	inline std::vector<LocConfig> &getLocations() { return locations; }
+	inline const std::vector<LocConfig> &getLocations() const { return locations; }
+	inline const LocationTrie &getLocationTrie() const { return location_trie; }
 	std::string getErrorPage(uint16_t status) const {
 		std::map<uint16_t, std::string>::const_iterator it = error_pages.find(status);
 		return (it != error_pages.end()) ? it->second : "";
 	}
+	inline const ErrorBody *findErrorBody(uint16_t status) const {
+		std::map<uint16_t, ErrorBody>::const_iterator it = error_bodies.find(status);
+		return (it != error_bodies.end()) ? &it->second : NULL;
+	}
+	inline void setErrorBody(uint16_t status, const std::string &body, const std::string &type) {
+		error_bodies[status].body = body;
+		error_bodies[status].content_type = type;
+	}
 
 	// The default location
 	LocConfig *defaultLocation() {
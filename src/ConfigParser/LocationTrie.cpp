@@ -0,0 +1,114 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LocationTrie.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/01 09:30:12 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/01 09:30:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "LocationTrie.hpp"
+
+static const size_t NO_NODE = static_cast<size_t>(-1);
+
+LocationTrie::LocationTrie() { addNode("", -1); }
+
+void LocationTrie::build(const std::vector<std::string> &paths) {
+	_nodes.clear();
+	addNode("", -1);
+	for (size_t i = 0; i < paths.size(); ++i) {
+		// The default location sits on the root: it matches any URI
+		if (paths[i].empty() || paths[i] == "/")
+			_nodes[0].location = static_cast<int>(i);
+		else
+			insert(paths[i], static_cast<int>(i));
+	}
+}
+
+int LocationTrie::find(const std::string &uri, bool &exact) const {
+	int best = _nodes[0].location;
+	exact = best >= 0 && uri == "/";
+	size_t node = 0;
+	size_t pos = 0;
+	while (pos < uri.size()) {
+		size_t child = findChild(node, uri[pos]);
+		if (child == NO_NODE)
+			break;
+		const std::string &label = _nodes[child].label;
+		if (uri.compare(pos, label.size(), label) != 0)
+			break;
+		pos += label.size();
+		node = child;
+		if (_nodes[node].location < 0)
+			continue;
+		// "/img" matches "/img" and "/img/a.png" but not "/images"
+		if (pos == uri.size()) {
+			best = _nodes[node].location;
+			exact = true;
+		} else if (uri[pos] == '/' || uri[pos - 1] == '/') {
+			best = _nodes[node].location;
+			exact = false;
+		}
+	}
+	return best;
+}
+
+void LocationTrie::insert(const std::string &path, int location) {
+	size_t node = 0;
+	size_t pos = 0;
+	while (pos < path.size()) {
+		size_t child = findChild(node, path[pos]);
+		if (child == NO_NODE) {
+			size_t leaf = addNode(path.substr(pos), location);
+			std::vector<size_t> &children = _nodes[node].children;
+			std::vector<size_t>::iterator it = children.begin();
+			while (it != children.end() && _nodes[*it].label[0] < path[pos])
+				++it;
+			children.insert(it, leaf);
+			return;
+		}
+		std::string label = _nodes[child].label;
+		size_t common = 0;
+		while (common < label.size() && pos + common < path.size() &&
+		       label[common] == path[pos + common])
+			++common;
+		if (common < label.size()) {
+			// Split the edge: the shared part becomes a node of its own
+			size_t mid = addNode(label.substr(0, common), -1);
+			_nodes[child].label = label.substr(common);
+			_nodes[mid].children.push_back(child);
+			std::vector<size_t> &children = _nodes[node].children;
+			*std::find(children.begin(), children.end(), child) = mid;
+			child = mid;
+		}
+		node = child;
+		pos += common;
+	}
+	_nodes[node].location = location;
+}
+
+size_t LocationTrie::addNode(const std::string &label, int location) {
+	_nodes.push_back(Node());
+	_nodes.back().label = label;
+	_nodes.back().location = location;
+	return _nodes.size() - 1;
+}
+
+size_t LocationTrie::findChild(size_t node, char c) const {
+	const std::vector<size_t> &children = _nodes[node].children;
+	size_t low = 0;
+	size_t high = children.size();
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (_nodes[children[mid]].label[0] < c)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low < children.size() && _nodes[children[low]].label[0] == c)
+		return children[low];
+	return NO_NODE;
+}
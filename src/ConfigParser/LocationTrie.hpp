@@ -0,0 +1,55 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LocationTrie.hpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/01 09:30:12 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/01 09:30:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOCATIONTRIE_HPP
+#define LOCATIONTRIE_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Radix trie of the location paths of a server, built once after parsing and
+/// read-only afterwards, so event loops share it without locking.
+///
+/// Each node holds the edge label that leads to it and the index of the
+/// location whose path ends there, if any. A lookup walks the URI once,
+/// comparing labels in place, and remembers the deepest location whose path
+/// is a valid prefix of the URI: it matches the whole URI, is followed by a
+/// '/', or ends with one itself. "/" matches any URI.
+class LocationTrie {
+  public:
+	LocationTrie();
+
+	/// Rebuilds the trie from location paths.
+	/// \param paths Location paths; indices into it are what find() returns.
+	void build(const std::vector<std::string> &paths);
+
+	/// Finds the longest location matching a URI, without allocating.
+	/// \param uri Request URI.
+	/// \param exact Set to whether the location path is the whole URI.
+	/// \returns Index of the location in the paths given to build(), -1 if
+	///          none matches.
+	int find(const std::string &uri, bool &exact) const;
+
+  private:
+	struct Node {
+		std::string label;          // bytes of the edge from the parent
+		int location;               // index of the location ending here, -1 if none
+		std::vector<size_t> children; // node indices, sorted by first label byte
+	};
+
+	std::vector<Node> _nodes; // _nodes[0] is the root, with an empty label
+
+	void insert(const std::string &path, int location);
+	size_t addNode(const std::string &label, int location);
+	size_t findChild(size_t node, char c) const;
+};
+
+#endif
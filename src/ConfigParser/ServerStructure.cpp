@@ -12,16 +12,43 @@
 
 #include "ConfigParser.hpp"
 
-bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers) {
+bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<ServerConfig> &servers,
+                                       GlobalConfig &global) {
 
 	for (std::vector<ConfigNode>::const_iterator node = tree.children_.begin();
 	     node != tree.children_.end(); ++node) {
 
 		if (node->name_ == "http") {
-			if (!convertTreeToStruct(*node, servers))
+			if (!convertTreeToStruct(*node, servers, global))
 				return false;
 		}
 
+		else if (node->name_ == "worker_processes")
+			handleWorkers(*node, global);
+		else if (node->name_ == "worker_threads")
+			handleThreads(*node, global);
+		else if (node->name_ == "edge_triggered")
+			global.setEdgeTriggered(node->args_[0] == "on");
+		else if (node->name_ == "open_file_cache" || node->name_ == "open_file_cache_valid")
+			handleOpenFileCache(*node, global);
+		else if (node->name_ == "static_cache_max_bytes")
+			global.static_cache_max_bytes = parseSize(node->args_[0]);
+		else if (node->name_ == "static_cache_max_file")
+			global.static_cache_max_file = parseSize(node->args_[0]);
+		else if (node->name_ == "static_mmap" && node->args_[0] != "off") {
+			global.static_mmap_min = parseSize(node->args_[0]);
+			global.static_mmap_max = parseSize(node->args_[1]);
+		} else if (node->name_ == "gzip")
+			global.gzip = node->args_[0] == "on";
+		else if (node->name_ == "gzip_static")
+			global.gzip_static = node->args_[0] == "on";
+		else if (node->name_ == "gzip_comp_level")
+			global.gzip_comp_level = std::atoi(node->args_[0].c_str());
+		else if (node->name_ == "gzip_min_length")
+			global.gzip_min_length = parseSize(node->args_[0]);
+		else if (node->name_ == "client_body_buffer_size")
+			global.client_body_buffer_size = parseSize(node->args_[0]);
+
 		else if (node->name_ == "server") {
 
 			ServerConfig server;
@@ -36,6 +63,12 @@ bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<Serve
 					handleErrorPage(*child, server);
 				else if (child->name_ == "client_max_body_size")
 					handleBodySize(*child, server);
+				else if (child->name_ == "client_header_timeout" ||
+				         child->name_ == "client_body_timeout" ||
+				         child->name_ == "keepalive_timeout" || child->name_ == "send_timeout")
+					handleTimeout(*child, server);
+				else if (child->name_ == "accept_batch")
+					handleAcceptBatch(*child, server);
 
 				else if (child->name_ == "location") {
 					LocConfig location;
@@ -75,7 +108,7 @@ bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<Serve
 			}
 
 			inheritGeneralConfig(server, forInheritance);
-			sortLocations(server.locations);
+			sortLocations(server);
 			addRootToErrorUri(server);
 
 			logg_.logWithPrefix(Logger::INFO, "Config parsing",
@@ -94,6 +127,34 @@ bool ConfigParser::convertTreeToStruct(const ConfigNode &tree, std::vector<Serve
 	return true;
 }
 
+// WORKER PROCESSES - "auto" means one worker per online CPU, at most MAX_WORKER_PROCESSES
+void ConfigParser::handleWorkers(const ConfigNode &node, GlobalConfig &global) {
+	if (node.args_[0] == "auto") {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		global.setWorkerProcesses(cpus > 0 ? static_cast<int>(cpus) : 1);
+	} else
+		global.setWorkerProcesses(std::atoi(node.args_[0].c_str()));
+}
+
+// WORKER THREADS - event loops per process, "auto" means one per online CPU (bounded too)
+void ConfigParser::handleThreads(const ConfigNode &node, GlobalConfig &global) {
+	if (node.args_[0] == "auto") {
+		long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+		global.setWorkerThreads(cpus > 0 ? static_cast<int>(cpus) : 1);
+	} else
+		global.setWorkerThreads(std::atoi(node.args_[0].c_str()));
+}
+
+// OPEN FILE CACHE - entries per event loop ("off" = 0), and their validity in seconds
+void ConfigParser::handleOpenFileCache(const ConfigNode &node, GlobalConfig &global) {
+	std::string value = node.args_[0];
+	if (node.name_ == "open_file_cache") {
+		global.open_file_cache = (value == "off") ? 0 : std::atoi(value.c_str());
+		return;
+	}
+	global.open_file_cache_valid = parseTime(value);
+}
+
 // HOST AND PORT
 void ConfigParser::handleListen(const ConfigNode &node, ServerConfig &server) {
 	std::string value = node.args_[0];
@@ -116,12 +177,10 @@ void ConfigParser::handleErrorPage(const ConfigNode &node, ServerConfig &server)
 	}
 }
 
-// MAX BODY SIZE
-void ConfigParser::handleBodySize(const ConfigNode &node, ServerConfig &server) {
-
-	// megabits or giga
-	int factor = 1;
-	char last = su::back(node.args_[0]);
+// SIZES - bytes, or K/M/G (case insensitive) suffix
+size_t ConfigParser::parseSize(const std::string &value) {
+	size_t factor = 1;
+	char last = su::back(value);
 	if (std::tolower(last) == 'k')
 		factor = 1024;
 	else if (std::tolower(last) == 'm')
@@ -129,14 +188,54 @@ void ConfigParser::handleBodySize(const ConfigNode &node, ServerConfig &server)
 	else if (std::tolower(last) == 'g')
 		factor = 1024 * 1024 * 1024;
 
-	std::string maxBody = node.args_[0];
+	std::string number = value;
 	if (factor > 1)
-		maxBody = su::rtrim(maxBody.substr(0, maxBody.size() - 1));
+		number = su::rtrim(number.substr(0, number.size() - 1));
+
+	std::istringstream iss(number);
+	size_t size;
+	iss >> size;
+	return size * factor;
+}
+
+// TIMES - seconds, or minutes with the 'm' suffix ("30", "30s", "2m"), -1 if malformed
+long ConfigParser::parseTime(const std::string &value) {
+	long factor = 1;
+	std::string number = value;
+	char last = value.empty() ? '\0' : std::tolower(su::back(value));
+	if (last == 'm')
+		factor = 60;
+	if (last == 's' || last == 'm')
+		number = number.substr(0, number.size() - 1);
+
+	std::istringstream iss(number);
+	long seconds;
+	if (number.empty() || !(iss >> seconds) || !iss.eof())
+		return -1;
+	return seconds * factor;
+}
+
+// MAX BODY SIZE
+void ConfigParser::handleBodySize(const ConfigNode &node, ServerConfig &server) {
+	server.client_max_body_size = parseSize(node.args_[0]);
+}
+
+// TIMEOUTS - seconds, or minutes with the 'm' suffix
+void ConfigParser::handleTimeout(const ConfigNode &node, ServerConfig &server) {
+	int seconds = parseTime(node.args_[0]);
+	if (node.name_ == "client_header_timeout")
+		server.client_header_timeout = seconds;
+	else if (node.name_ == "client_body_timeout")
+		server.client_body_timeout = seconds;
+	else if (node.name_ == "keepalive_timeout")
+		server.keepalive_timeout = seconds;
+	else
+		server.send_timeout = seconds;
+}
 
-	std::istringstream iss(maxBody);
-	size_t maxBodyFactor;
-	iss >> maxBodyFactor;
-	server.client_max_body_size = maxBodyFactor * factor;
+// ACCEPT BATCH - connections accepted per wakeup of the listener
+void ConfigParser::handleAcceptBatch(const ConfigNode &node, ServerConfig &server) {
+	server.accept_batch = std::atoi(node.args_[0].c_str());
 }
 
 // Root, Methods, Upload path, autoindex and CGI can be defined server level -> for inheritance
@@ -291,8 +390,13 @@ void ConfigParser::addRootToErrorUri(ServerConfig &server) {
 }
 
 // SORT LOCATIONS by path length (longest first for proper nginx-style matching)
-void ConfigParser::sortLocations(std::vector<LocConfig> &locations) {
-	std::sort(locations.begin(), locations.end(), compareLocationPaths);
+// and index their paths for the per-request lookup
+void ConfigParser::sortLocations(ServerConfig &server) {
+	std::sort(server.locations.begin(), server.locations.end(), compareLocationPaths);
+	std::vector<std::string> paths;
+	for (size_t i = 0; i < server.locations.size(); ++i)
+		paths.push_back(server.locations[i].path);
+	server.location_trie.build(paths);
 }
 bool ConfigParser::compareLocationPaths(const LocConfig &a, const LocConfig &b) {
 	if (a.path.length() != b.path.length())
@@ -27,6 +27,32 @@ void ConfigParser::initValidDirectives() {
 	    Validity("http", std::vector<std::string>(1, "main"), true, 0, 0, NULL));
 	validDirectives_.push_back(
 	    Validity("server", std::vector<std::string>(1, "http"), true, 0, 0, NULL));
+	validDirectives_.push_back(Validity("worker_processes", makeVector("main", "http"), false, 1,
+	                                    1, &ConfigParser::validateWorkers));
+	validDirectives_.push_back(Validity("worker_threads", makeVector("main", "http"), false, 1, 1,
+	                                    &ConfigParser::validateThreads));
+	validDirectives_.push_back(Validity("edge_triggered", makeVector("main", "http"), false, 1, 1,
+	                                    &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("open_file_cache", makeVector("main", "http"), false, 1,
+	                                    1, &ConfigParser::validateOpenFileCache));
+	validDirectives_.push_back(Validity("open_file_cache_valid", makeVector("main", "http"), false,
+	                                    1, 1, &ConfigParser::validateTimeout));
+	validDirectives_.push_back(Validity("static_cache_max_bytes", makeVector("main", "http"),
+	                                    false, 1, 1, &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("static_cache_max_file", makeVector("main", "http"),
+	                                    false, 1, 1, &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("static_mmap", makeVector("main", "http"), false, 1, 2,
+	                                    &ConfigParser::validateMmapBand));
+	validDirectives_.push_back(Validity("gzip", makeVector("main", "http"), false, 1, 1,
+	                                    &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("gzip_static", makeVector("main", "http"), false, 1, 1,
+	                                    &ConfigParser::validateOnOff));
+	validDirectives_.push_back(Validity("gzip_comp_level", makeVector("main", "http"), false, 1,
+	                                    1, &ConfigParser::validateCompLevel));
+	validDirectives_.push_back(Validity("gzip_min_length", makeVector("main", "http"), false, 1,
+	                                    1, &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("client_body_buffer_size", makeVector("main", "http"),
+	                                    false, 1, 1, &ConfigParser::validateMaxBody));
 	// server only level
 	validDirectives_.push_back(Validity("listen", std::vector<std::string>(1, "server"), false, 1,
 	                                    1, &ConfigParser::validateListen));
@@ -35,6 +61,18 @@ void ConfigParser::initValidDirectives() {
 	validDirectives_.push_back(Validity("client_max_body_size",
 	                                    std::vector<std::string>(1, "server"), false, 1, 1,
 	                                    &ConfigParser::validateMaxBody));
+	validDirectives_.push_back(Validity("client_header_timeout",
+	                                    std::vector<std::string>(1, "server"), false, 1, 1,
+	                                    &ConfigParser::validateTimeout));
+	validDirectives_.push_back(Validity("client_body_timeout",
+	                                    std::vector<std::string>(1, "server"), false, 1, 1,
+	                                    &ConfigParser::validateTimeout));
+	validDirectives_.push_back(Validity("keepalive_timeout", std::vector<std::string>(1, "server"),
+	                                    false, 1, 1, &ConfigParser::validateTimeout));
+	validDirectives_.push_back(Validity("send_timeout", std::vector<std::string>(1, "server"), false,
+	                                    1, 1, &ConfigParser::validateTimeout));
+	validDirectives_.push_back(Validity("accept_batch", std::vector<std::string>(1, "server"), false,
+	                                    1, 1, &ConfigParser::validateAcceptBatch));
 	validDirectives_.push_back(Validity("location", std::vector<std::string>(1, "server"), true, 1,
 	                                    1, &ConfigParser::validateLocation));
 	// server or location level  (will be inherited in the locations if not set in the location)
@@ -50,7 +88,7 @@ void ConfigParser::initValidDirectives() {
 	                                    &ConfigParser::validateIndex));
 	// location only level
 	validDirectives_.push_back(Validity("autoindex", std::vector<std::string>(1, "location"), false,
-	                                    1, 1, &ConfigParser::validateAutoIndex));
+	                                    1, 1, &ConfigParser::validateOnOff));
 	validDirectives_.push_back(Validity("return", std::vector<std::string>(1, "location"), false, 1,
 	                                    2, &ConfigParser::validateReturn));
 }
@@ -200,12 +238,12 @@ bool ConfigParser::validateError(const ConfigNode &node) {
 	return true;
 }
 
-// in bits - M, K ou G at the end accepted
+// in bytes - M, K ou G at the end accepted (client_max_body_size, static_cache_max_*)
 bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 	std::string maxBody = node.args_[0];
 	if (maxBody.empty()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size cannot be empty on line " +
+		                    node.name_ + " cannot be empty on line " +
 		                        su::to_string(node.line_));
 		return false;
 	}
@@ -214,7 +252,7 @@ bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 		maxBody = su::rtrim(maxBody.substr(0, maxBody.size() - 1));
 	if (maxBody.empty()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size invalid format: '" + node.args_[0] +
+		                    node.name_ + " invalid format: '" + node.args_[0] +
 		                        "' on line " + su::to_string(node.line_));
 		return false;
 	}
@@ -222,7 +260,7 @@ bool ConfigParser::validateMaxBody(const ConfigNode &node) {
 	unsigned int n;
 	if (!(iss >> n) || iss.fail() || !iss.eof()) {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "client_max_body_size is invalid: '" + node.args_[0] + "' on line " +
+		                    node.name_ + " is invalid: '" + node.args_[0] + "' on line " +
 		                        su::to_string(node.line_));
 		return false;
 	}
@@ -298,10 +336,123 @@ bool ConfigParser::validateMethod(const ConfigNode &node) {
 	return true;
 }
 
-bool ConfigParser::validateAutoIndex(const ConfigNode &node) {
+// WORKER_PROCESSES: "auto" or 1-MAX_WORKER_PROCESSES
+bool ConfigParser::validateWorkers(const ConfigNode &node) {
+	if (node.args_[0] == "auto")
+		return true;
+	std::istringstream iss(node.args_[0]);
+	int n;
+	if (!(iss >> n) || iss.fail() || !iss.eof() || n < 1 || n > MAX_WORKER_PROCESSES) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "worker_processes must be 'auto' or between 1 and " +
+		                        su::to_string(MAX_WORKER_PROCESSES) + ". Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// WORKER_THREADS: "auto" or 1-MAX_WORKER_THREADS
+bool ConfigParser::validateThreads(const ConfigNode &node) {
+	if (node.args_[0] == "auto")
+		return true;
+	std::istringstream iss(node.args_[0]);
+	int n;
+	if (!(iss >> n) || iss.fail() || !iss.eof() || n < 1 || n > MAX_WORKER_THREADS) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "worker_threads must be 'auto' or between 1 and " +
+		                        su::to_string(MAX_WORKER_THREADS) + ". Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// TIMEOUTS: 1-MAX_TIMEOUT seconds, "30", "30s" or "2m"
+bool ConfigParser::validateTimeout(const ConfigNode &node) {
+	long seconds = parseTime(node.args_[0]);
+	if (seconds < 1 || seconds > MAX_TIMEOUT) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    node.name_ + " must be between 1s and " + su::to_string(MAX_TIMEOUT) +
+		                        "s. Value " + node.args_[0] + " on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// ACCEPT_BATCH: 1-MAX_ACCEPT_BATCH
+bool ConfigParser::validateAcceptBatch(const ConfigNode &node) {
+	std::istringstream iss(node.args_[0]);
+	int n;
+	if (!(iss >> n) || iss.fail() || !iss.eof() || n < 1 || n > MAX_ACCEPT_BATCH) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "accept_batch must be between 1 and " + su::to_string(MAX_ACCEPT_BATCH) +
+		                        ". Value " + node.args_[0] + " on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// OPEN_FILE_CACHE: "off" or 1-MAX_OPEN_FILE_CACHE
+bool ConfigParser::validateOpenFileCache(const ConfigNode &node) {
+	if (node.args_[0] == "off")
+		return true;
+	std::istringstream iss(node.args_[0]);
+	int n;
+	if (!(iss >> n) || iss.fail() || !iss.eof() || n < 1 || n > MAX_OPEN_FILE_CACHE) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "open_file_cache must be 'off' or between 1 and " +
+		                        su::to_string(MAX_OPEN_FILE_CACHE) + ". Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// STATIC_MMAP: "off", or two sizes (min max) with min <= max
+bool ConfigParser::validateMmapBand(const ConfigNode &node) {
+	if (node.args_.size() == 1 && node.args_[0] == "off")
+		return true;
+	if (node.args_.size() != 2) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "static_mmap expects 'off' or a minimum and a maximum size on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	for (size_t i = 0; i < node.args_.size(); ++i) {
+		ConfigNode size(node.name_, std::vector<std::string>(1, node.args_[i]), node.line_);
+		if (!validateMaxBody(size))
+			return false;
+	}
+	if (parseSize(node.args_[0]) > parseSize(node.args_[1])) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "static_mmap minimum is larger than the maximum on line " +
+		                        su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// GZIP_COMP_LEVEL: 1-9
+bool ConfigParser::validateCompLevel(const ConfigNode &node) {
+	std::istringstream iss(node.args_[0]);
+	int n;
+	if (!(iss >> n) || iss.fail() || !iss.eof() || n < 1 || n > 9) {
+		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
+		                    "gzip_comp_level must be between 1 and 9. Value " + node.args_[0] +
+		                        " on line " + su::to_string(node.line_));
+		return false;
+	}
+	return true;
+}
+
+// AUTOINDEX, EDGE_TRIGGERED, ...: flags
+bool ConfigParser::validateOnOff(const ConfigNode &node) {
 	if (node.args_[0] != "on" && node.args_[0] != "off") {
 		logg_.logWithPrefix(Logger::WARNING, "Configuration file",
-		                    "autoindex must be 'on' or 'off'. Value " + node.args_[0] +
+		                    node.name_ + " must be 'on' or 'off'. Value " + node.args_[0] +
 		                        " on line " + su::to_string(node.line_));
 		return false;
 	}
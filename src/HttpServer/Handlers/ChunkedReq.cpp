@@ -15,132 +15,167 @@
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 
-bool WebServer::processChunkSize(Connection *conn) {
-	size_t crlf_pos = findCRLF(conn->read_buffer);
-	if (crlf_pos == std::string::npos) {
-		// Need more data to read chunk size
+// chunk-size is 1*HEXDIG, the extensions after ';' are ignored
+static bool parseChunkSize(std::string line, size_t &size) {
+	size_t semicolon_pos = line.find(';');
+	if (semicolon_pos != std::string::npos)
+		line = line.substr(0, semicolon_pos);
+	line = su::trim(line);
+	if (line.empty())
 		return false;
+	size = 0;
+	for (size_t i = 0; i < line.size(); ++i) {
+		if (!std::isxdigit(static_cast<unsigned char>(line[i])) || size > (SIZE_MAX >> 4))
+			return false;
+		size = (size << 4) | (std::isdigit(static_cast<unsigned char>(line[i]))
+		                          ? line[i] - '0'
+		                          : std::tolower(static_cast<unsigned char>(line[i])) - 'a' + 10);
 	}
+	return true;
+}
 
-	std::string chunk_size_line = conn->read_buffer.substr(0, crlf_pos);
+// The chunks are decoded where they were received, right after the headers
+// (which the parser reads in place), and the decoded bytes go to conn->body.
+// What was decoded leaves read_buffer once per call; what follows the last
+// chunk is the next pipelined request and stays.
+bool WebServer::receiveChunks(Connection *conn) {
+	size_t pos = conn->header_length; // first byte not decoded yet
+	bool progress = true;
+
+	while (progress) {
+		switch (conn->state) {
+		case Connection::READING_CHUNK_SIZE:
+			progress = processChunkSize(conn, pos);
+			break;
+		case Connection::READING_CHUNK_DATA:
+			progress = processChunkData(conn, pos);
+			break;
+		case Connection::READING_TRAILER:
+			progress = processTrailer(conn, pos);
+			break;
+		default:
+			progress = false;
+		}
+	}
+	conn->read_buffer.erase(conn->header_length, pos - conn->header_length);
+	return conn->state == Connection::REQUEST_COMPLETE;
+}
 
-	conn->read_buffer = conn->read_buffer.substr(crlf_pos + 2);
+void WebServer::handleBadChunk(Connection *conn, const std::string &reason, int status) {
+	_lggr.warn("Invalid chunked body from fd " + su::to_string(conn->fd) + ": " + reason);
+	// Where the next request starts is not known
+	conn->keep_persistent_connection = false;
+	prepareResponse(conn, Response(status, conn));
+}
 
-	// ignore chunk extensions after ';'
-	size_t semicolon_pos = chunk_size_line.find(';');
-	if (semicolon_pos != std::string::npos) {
-		chunk_size_line = chunk_size_line.substr(0, semicolon_pos);
+// A partial line stays at the start of the undecoded bytes, so what was
+// searched of it is still there: only the new bytes are scanned.
+size_t WebServer::findChunkLine(Connection *conn, size_t pos) {
+	const IOBuffer &in = conn->read_buffer;
+	// The last byte searched may be the CR of a CRLF split across two reads
+	size_t from = conn->chunk_line_scanned > 0 ? conn->chunk_line_scanned - 1 : 0;
+	size_t crlf_pos = findCRLF(in.data() + pos + from, in.size() - pos - from);
+	size_t length = (crlf_pos == std::string::npos) ? in.size() - pos : from + crlf_pos;
+
+	if (length > MAX_CHUNK_LINE) {
+		handleBadChunk(conn, "line longer than " + su::to_string(MAX_CHUNK_LINE) + " bytes");
+		return std::string::npos;
+	}
+	conn->chunk_line_scanned = (crlf_pos == std::string::npos) ? length : 0;
+	return (crlf_pos == std::string::npos) ? std::string::npos : length;
+}
+
+bool WebServer::processChunkSize(Connection *conn, size_t &pos) {
+	const IOBuffer &in = conn->read_buffer;
+	size_t line_length = findChunkLine(conn, pos);
+	if (line_length == std::string::npos) {
+		// Need more data to read chunk size
+		return false;
 	}
 
-	chunk_size_line = su::trim(chunk_size_line);
+	std::string chunk_size_line(in.data() + pos, line_length);
+	pos += line_length + 2;
 
-	// TODO: Check for negative?
-	conn->chunk_size = static_cast<size_t>(std::strtol(chunk_size_line.c_str(), NULL, 16));
+	if (!parseChunkSize(chunk_size_line, conn->chunk_size)) {
+		handleBadChunk(conn, "chunk size \"" + chunk_size_line + "\"");
+		return false;
+	}
 	conn->chunk_bytes_read = 0;
 
 	_lggr.debug("Chunk size: " + su::to_string(conn->chunk_size));
 
-	if (conn->chunk_size == 0) {
-		// Last chunk, read trailers
-		conn->state = Connection::READING_TRAILER;
-		return processTrailer(conn);
-	} else {
-		conn->state = Connection::READING_CHUNK_DATA;
-		return processChunkData(conn);
-	}
+	// The last chunk is followed by the trailers
+	conn->state = conn->chunk_size == 0 ? Connection::READING_TRAILER
+	                                    : Connection::READING_CHUNK_DATA;
+	return true;
 }
 
-bool WebServer::processChunkData(Connection *conn) {
-	size_t available_data = conn->read_buffer.length();
-	size_t bytes_needed = conn->chunk_size - conn->chunk_bytes_read;
-
-	if (available_data < bytes_needed + 2) { // +2 for trailing CRLF
-		// Need more data
-		return false;
-	}
-
-	size_t bytes_to_read = bytes_needed;
-	std::string chunk_part = conn->read_buffer.substr(0, bytes_to_read);
+bool WebServer::processChunkData(Connection *conn, size_t &pos) {
+	const IOBuffer &in = conn->read_buffer;
+	// What arrived of the chunk goes to the body right away: a large chunk is
+	// never held whole in read_buffer
+	size_t bytes_to_read = std::min(in.size() - pos, conn->chunk_size - conn->chunk_bytes_read);
 
 	// Max client body size check
 	if (!conn->getServerConfig()->infiniteBodySize() &&
-	    (conn->chunk_data.length() + bytes_to_read) > conn->getServerConfig()->getMaxBodySize()) {
+	    (conn->body.size() + bytes_to_read) > conn->getServerConfig()->getMaxBodySize()) {
 		_lggr.debug("Chunked request is too large");
-		handleRequestTooLarge(conn, bytes_to_read);
+		handleRequestTooLarge(conn, conn->body.size() + bytes_to_read);
 		return false;
 	}
-	
-	conn->chunk_data += chunk_part;
-	conn->chunk_bytes_read += bytes_to_read;
 
-	conn->read_buffer = conn->read_buffer.substr(bytes_to_read);
+	if (!conn->body.append(in.data() + pos, bytes_to_read)) {
+		_lggr.error("Could not store the request body of fd " + su::to_string(conn->fd) + ": " +
+		            strerror(errno));
+		conn->keep_persistent_connection = false;
+		prepareResponse(conn, Response::internalServerError(conn));
+		return false;
+	}
+	conn->chunk_bytes_read += bytes_to_read;
+	pos += bytes_to_read;
+	if (conn->chunk_bytes_read < conn->chunk_size) {
+		// Need more data
+		return false;
+	}
 
 	// Check if there are trailing CRLF
-	if (conn->read_buffer.length() < 2) {
+	if (in.size() - pos < 2) {
 		return false;
 	}
 
-	if (conn->read_buffer.substr(0, 2) != "\r\n") {
-		_lggr.error("Invalid chunk format: missing trailing CRLF");
+	if (std::memcmp(in.data() + pos, "\r\n", 2) != 0) {
+		handleBadChunk(conn, "missing CRLF after the chunk data");
 		return false;
 	}
-
-	// Remove trailing CRLF
-	conn->read_buffer = conn->read_buffer.substr(2);
+	pos += 2;
 
 	conn->state = Connection::READING_CHUNK_SIZE;
-	return processChunkSize(conn);
+	return true;
 }
 
-bool WebServer::processTrailer(Connection *conn) {
-	size_t trailer_end = findCRLF(conn->read_buffer);
+bool WebServer::processTrailer(Connection *conn, size_t &pos) {
+	size_t trailer_end = findChunkLine(conn, pos);
 
 	if (trailer_end == std::string::npos) {
 		// Need more data
 		return false;
 	}
-
-	std::string trailer_line = conn->read_buffer.substr(0, trailer_end);
-	conn->read_buffer = conn->read_buffer.substr(trailer_end + 2);
-
-	// If trailer line is empty, we're done
-	if (trailer_line.empty()) {
-		conn->state = Connection::CHUNK_COMPLETE;
-
-		reconstructChunkedRequest(conn);
-		return true;
-	}
-
-	return processTrailer(conn);
-}
-
-// TODO: add more debuggin info
-void WebServer::reconstructChunkedRequest(Connection *conn) {
-	std::string reconstructed_request = conn->headers_buffer;
-
-	std::string headers_lower = su::to_lower(reconstructed_request);
-
-	size_t te_pos = headers_lower.find("transfer-encoding: chunked");
-	if (te_pos != std::string::npos) {
-		// Find the end of this header line
-		size_t line_end = reconstructed_request.find("\r\n", te_pos);
-		if (line_end != std::string::npos) {
-			// Remove the Transfer-Encoding line
-			reconstructed_request.erase(te_pos, line_end - te_pos + 2);
-		}
+	pos += trailer_end + 2;
+
+	// Trailer fields are skipped, but they are bounded like the request head:
+	// short lines must not hold the connection forever
+	conn->trailer_length += trailer_end + 2;
+	if (conn->trailer_length > MAX_HEAD_LENGTH) {
+		handleBadChunk(conn, "trailers longer than " + su::to_string(MAX_HEAD_LENGTH) + " bytes",
+		               431);
+		return false;
 	}
-
-	// Add Content-Length header before the final CRLF
-	size_t final_crlf = reconstructed_request.find("\r\n\r\n");
-	if (final_crlf != std::string::npos) {
-		std::string content_length_header =
-		    "\r\nContent-Length: " + su::to_string(conn->chunk_data.length()) + "\r\n";
-		reconstructed_request.insert(final_crlf, content_length_header);
+	// An empty line ends the body
+	if (trailer_end == 0) {
+		conn->body_bytes_read = conn->body.size();
+		conn->state = Connection::REQUEST_COMPLETE;
+		_lggr.debug("Decoded chunked request, total body size: " +
+		            su::to_string(conn->body.size()));
 	}
-
-	conn->read_buffer = reconstructed_request + conn->chunk_data;
-	conn->state = Connection::REQUEST_COMPLETE;
-
-	_lggr.debug("Reconstructed chunked request, total body size: " +
-	            su::to_string(conn->chunk_data.length()));
+	return true;
 }
@@ -0,0 +1,119 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   CompressedReq.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/30 10:02:11 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/30 10:02:11 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/FileCache.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+#include <zlib.h>
+
+static const size_t GZIP_CHUNK = 64 * 1024; // bytes of the file read and deflated at a time
+
+// Whether a q-value is zero, "not acceptable"
+static bool isZeroQuality(const std::string &q) {
+	return q.find_first_not_of("0.") == std::string::npos;
+}
+
+// Whether Accept-Encoding allows a content coding. An explicit entry wins
+// over "*", q=0 refuses the coding.
+static bool acceptsCoding(const ClientRequest &req, const std::string &coding) {
+	const std::string *accept = req.headers.get(RequestHeaders::ACCEPT_ENCODING);
+	if (!accept)
+		return false;
+	std::istringstream list(*accept);
+	std::string element;
+	int star = -1;
+	while (std::getline(list, element, ',')) {
+		size_t semicolon = element.find(';');
+		std::string name = su::to_lower(su::trim(element.substr(0, semicolon)));
+		bool accepted = true;
+		// The weight is a parameter: "q=" in the coding name itself is not one
+		std::istringstream params(semicolon == std::string::npos ? ""
+		                                                         : element.substr(semicolon + 1));
+		std::string param;
+		while (std::getline(params, param, ';')) {
+			param = su::trim(param);
+			if (param.size() > 2 && std::tolower(param[0]) == 'q' && param[1] == '=')
+				accepted = !isZeroQuality(su::trim(param.substr(2)));
+		}
+		if (name == coding)
+			return accepted;
+		if (name == "*")
+			star = accepted;
+	}
+	return star == 1;
+}
+
+CachedFile *WebServer::findPrecompressed(const ClientRequest &req, const CachedFile &file,
+                                         std::string &encoding) {
+	static const char *codings[] = {"br", "gzip"};
+	static const char *suffixes[] = {".br", ".gz"};
+	for (size_t i = 0; i < 2; ++i) {
+		if (!acceptsCoding(req, codings[i]))
+			continue;
+		CachedFile *sibling = acquireFile(file.path + suffixes[i]);
+		if (!sibling)
+			continue;
+		if (sibling->is_dir) {
+			sibling->release();
+			continue;
+		}
+		encoding = codings[i];
+		return sibling;
+	}
+	return NULL;
+}
+
+bool WebServer::shouldGzip(const ClientRequest &req, const CachedFile &file) const {
+	return _global.isGzip() && file.compressible &&
+	       static_cast<size_t>(file.size) >= _global.getGzipMinLength() &&
+	       file.size <= GZIP_MAX_SIZE && !req.headers.get(RequestHeaders::RANGE) &&
+	       acceptsCoding(req, "gzip");
+}
+
+bool WebServer::gzipFile(const CachedFile &file, std::string &out) {
+	z_stream zs;
+	std::memset(&zs, 0, sizeof(zs));
+	// 15 + 16: the largest window, with a gzip header and trailer
+	if (deflateInit2(&zs, _global.getGzipCompLevel(), Z_DEFLATED, 15 + 16, 8,
+	                 Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+	// Sized once for the worst case, so deflate() never runs out of room
+	out.resize(deflateBound(&zs, static_cast<uLong>(file.size)));
+	zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+	zs.avail_out = static_cast<uInt>(out.size());
+
+	std::vector<char> chunk(GZIP_CHUNK);
+	off_t offset = 0;
+	int ret = Z_OK;
+	while (ret == Z_OK) {
+		ssize_t got = 0;
+		if (offset < file.size) {
+			size_t want = std::min(GZIP_CHUNK, static_cast<size_t>(file.size - offset));
+			got = pread(file.fd, &chunk[0], want, offset);
+			if (got <= 0)
+				break; // unreadable, or shorter than its size
+			offset += got;
+		}
+		zs.next_in = reinterpret_cast<Bytef *>(&chunk[0]);
+		zs.avail_in = static_cast<uInt>(got);
+		ret = deflate(&zs, offset < file.size ? Z_NO_FLUSH : Z_FINISH);
+	}
+	deflateEnd(&zs);
+	if (ret != Z_STREAM_END) {
+		_lggr.error("Failed to compress " + file.path);
+		out.clear();
+		return false;
+	}
+	out.resize(zs.total_out);
+	return true;
+}
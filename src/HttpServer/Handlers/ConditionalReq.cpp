@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConditionalReq.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/29 09:41:17 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/29 09:41:17 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/HttpServer/Structs/Conditional.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/FileCache.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/GeneralUtils.hpp"
+
+static std::string contentRange(off_t first, off_t last, off_t size) {
+	return "bytes " + su::to_string(first) + "-" + su::to_string(last) + "/" + su::to_string(size);
+}
+
+std::string WebServer::entityTag(const CachedFile &file) {
+	// Another write within the same second would keep size and mtime
+	if (file.mtime >= time(NULL) - 1)
+		return "W/" + file.etag;
+	return file.etag;
+}
+
+bool WebServer::isNotModified(const ClientRequest &req, const CachedFile &file,
+                              const std::string &etag) const {
+	// If-None-Match takes precedence over If-Modified-Since
+	if (const std::string *inm = req.headers.get(RequestHeaders::IF_NONE_MATCH))
+		return Conditional::matchesAny(*inm, etag);
+	if (const std::string *ims = req.headers.get(RequestHeaders::IF_MODIFIED_SINCE)) {
+		time_t since = parseHttpDate(*ims);
+		return since != -1 && file.mtime <= since;
+	}
+	return false;
+}
+
+bool WebServer::respRangeRequest(const ClientRequest &req, Connection *conn, CachedFile *file,
+                                 const std::string &etag, Response &resp) {
+	const std::string *range = req.headers.get(RequestHeaders::RANGE);
+	if (!range)
+		return false;
+	// The full file is sent when it changed since the client got its part
+	const std::string *if_range = req.headers.get(RequestHeaders::IF_RANGE);
+	if (if_range && !Conditional::ifRangeMatches(*if_range, etag, file->mtime))
+		return false;
+
+	std::vector<Conditional::ByteRange> ranges;
+	if (!Conditional::parseRanges(*range, file->size, ranges)) {
+		_lggr.debug("Ignoring Range header: " + *range);
+		return false;
+	}
+	if (ranges.empty()) {
+		_lggr.debug("Range not satisfiable: " + *range);
+		resp = Response(416, conn);
+		resp.setHeader("Content-Range", "bytes */" + su::to_string(file->size));
+		return true;
+	}
+
+	resp = Response(206);
+	resp.setHeader("ETag", etag);
+	resp.setHeader("Last-Modified", httpDate(file->mtime));
+	resp.setHeader("Accept-Ranges", "bytes");
+	bool mapped = _global.isMmapSize(file->size) && file->mapping();
+	if (ranges.size() == 1) {
+		resp.setContentType(file->content_type);
+		resp.setHeader("Content-Range", contentRange(ranges[0].first, ranges[0].last, file->size));
+		resp.setBodyFile(file, ranges[0].first,
+		                 static_cast<size_t>(ranges[0].last - ranges[0].first + 1), mapped);
+		return true;
+	}
+
+	// Several ranges: one part each, the file data stays where it is
+	std::ostringstream boundary;
+	boundary << std::hex << file->inode << file->mtime << conn->fd << '-' << conn->request_count;
+	resp.setContentType("multipart/byteranges; boundary=" + boundary.str());
+	resp.setBodyFile(file, 0, 0, mapped);
+	size_t length = 0;
+	for (size_t i = 0; i < ranges.size(); ++i) {
+		Response::BodyPart part;
+		part.head = "\r\n--" + boundary.str() + "\r\nContent-Type: " + file->content_type +
+		            "\r\nContent-Range: " +
+		            contentRange(ranges[i].first, ranges[i].last, file->size) + "\r\n\r\n";
+		part.offset = ranges[i].first;
+		part.length = static_cast<size_t>(ranges[i].last - ranges[i].first + 1);
+		length += part.head.size() + part.length;
+		resp.body_parts.push_back(part);
+	}
+	resp.body = "\r\n--" + boundary.str() + "--\r\n";
+	resp.setContentLength(length + resp.body.size());
+	return true;
+}
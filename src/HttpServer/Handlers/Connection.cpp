@@ -15,25 +15,149 @@
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 
-void WebServer::handleNewConnection(ServerConfig *sc) {
-	struct sockaddr_in client_addr;
-	socklen_t client_len = sizeof(client_addr);
+void WebServer::handleNewConnection(const ServerConfig *sc) {
+	int batch = sc->getAcceptBatch();
+	int accepted = 0;
 
-	int client_fd = accept(sc->getServerFD(), (struct sockaddr *)&client_addr, &client_len);
-	if (client_fd == -1) {
-		// TODO: cannot accept a connection with the client
+	++_accept_stats.wakeups;
+	// The listener is level-triggered: whatever is left past the batch is reported again
+	for (int i = 0; i < batch; ++i) {
+		struct sockaddr_in client_addr;
+		socklen_t client_len = sizeof(client_addr);
+
+		int client_fd = accept4(sc->getServerFD(), (struct sockaddr *)&client_addr, &client_len,
+		                        SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (client_fd == -1) {
+			if (errno == EINTR || errno == ECONNABORTED || errno == EPROTO)
+				continue;
+			if (errno == EMFILE || errno == ENFILE) {
+				shedConnection(sc);
+			} else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+				++_accept_stats.errors;
+				_lggr.error("accept failed on " + sc->getHost() + ":" +
+				            su::to_string(sc->getPort()) + ": " + std::string(strerror(errno)));
+			}
+			break;
+		}
+		++accepted;
+		registerClient(client_fd, sc, client_addr);
 	}
 
-	if (!setNonBlocking(client_fd)) {
+	_accept_stats.accepted += accepted;
+	if (accepted == batch)
+		++_accept_stats.full_batches;
+}
+
+void WebServer::shedConnection(const ServerConfig *sc) {
+	++_accept_stats.shed;
+	if (_reserve_fd == -1) {
+		_lggr.error("Out of file descriptors and no reserve descriptor left");
+		return;
+	}
+
+	// Free one descriptor to take the pending connection off the backlog and drop it,
+	// otherwise the level-triggered listener would wake us up in a loop
+	close(_reserve_fd);
+	int client_fd = accept(sc->getServerFD(), NULL, NULL);
+	if (client_fd != -1)
 		close(client_fd);
+	_reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+
+	_lggr.warn("Out of file descriptors, dropped a connection on " + sc->getHost() + ":" +
+	           su::to_string(sc->getPort()));
+}
+
+bool WebServer::openReserveFd() {
+	_reserve_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	if (_reserve_fd == -1) {
+		_lggr.error("Failed to open the reserve descriptor: " + std::string(strerror(errno)));
+		return false;
+	}
+	return true;
+}
+
+void WebServer::logStats() {
+	if (!_confs.empty())
+		logAcceptStats();
+	// With event loops the acceptor hands every connection over
+	if (_loops.empty()) {
+		logPoolStats();
+		logFileCacheStats();
+		logStaticCacheStats();
+	}
+}
+
+void WebServer::logPoolStats() {
+	ConnectionPool::Stats stats = _pool.stats();
+	unsigned long hit_rate = stats.acquired ? stats.reused * 100 / stats.acquired : 0;
+
+	_lggr.info(std::string(_owner ? "Loop " + su::to_string(_loop_id) + " p" : "P") +
+	           "ool stats: " + su::to_string(stats.acquired) + " acquired, " +
+	           su::to_string(hit_rate) + "% reused, " + su::to_string(stats.in_use) + "/" +
+	           su::to_string(stats.capacity) + " in use, " +
+	           su::to_string(stats.resident_bytes / 1024) + " KiB resident");
+}
+
+void WebServer::logFileCacheStats() {
+	if (!_files.enabled())
+		return;
+	FileCache::Stats stats = _files.stats();
+	unsigned long lookups = stats.hits + stats.revalidations + stats.misses;
+	unsigned long hit_rate = lookups ? stats.hits * 100 / lookups : 0;
+
+	_lggr.info(std::string(_owner ? "Loop " + su::to_string(_loop_id) + " o" : "O") +
+	           "pen-file cache: " + su::to_string(lookups) + " lookups, " +
+	           su::to_string(hit_rate) + "% hits, " + su::to_string(stats.revalidations) +
+	           " revalidated, " + su::to_string(stats.evictions) + " evicted, " +
+	           su::to_string(stats.entries) + " entries, " + su::to_string(stats.open_files) +
+	           " open files");
+}
+
+void WebServer::logStaticCacheStats() {
+	if (!_responses.enabled())
+		return;
+	StaticCache::Stats stats = _responses.stats();
+	unsigned long lookups = stats.hits + stats.misses + stats.stale;
+	unsigned long hit_rate = lookups ? stats.hits * 100 / lookups : 0;
+
+	_lggr.info(std::string(_owner ? "Loop " + su::to_string(_loop_id) + " s" : "S") +
+	           "tatic cache: " + su::to_string(lookups) + " lookups, " +
+	           su::to_string(hit_rate) + "% hits, " + su::to_string(stats.stale) + " stale, " +
+	           su::to_string(stats.evictions) + " evicted, " + su::to_string(stats.entries) +
+	           " responses, " + su::to_string(stats.bytes / 1024) + " KiB");
+}
+
+void WebServer::logAcceptStats() {
+	time_t elapsed = getCurrentTime() - _accept_stats.since;
+	if (elapsed < 1)
+		elapsed = 1;
+
+	_lggr.info("Accept stats: " + su::to_string(_accept_stats.accepted) + " accepted (" +
+	           su::to_string(_accept_stats.accepted / elapsed) + "/s over " +
+	           su::to_string(elapsed) + "s), " + su::to_string(_accept_stats.wakeups) +
+	           " wakeups, " + su::to_string(_accept_stats.full_batches) + " full batches, " +
+	           su::to_string(_accept_stats.shed) + " dropped (out of fds), " +
+	           su::to_string(_accept_stats.errors) + " errors");
+}
+
+void WebServer::registerClient(int client_fd, const ServerConfig *sc,
+                               const struct sockaddr_in &client_addr) {
+	if (!_loops.empty()) {
+		WebServer *loop = pickEventLoop();
+		loop->handOff(client_fd, sc);
+		_lggr.info("New connection from " + std::string(inet_ntoa(client_addr.sin_addr)) + ":" +
+		           su::to_string<unsigned short>(ntohs(client_addr.sin_port)) +
+		           " (fd: " + su::to_string<int>(client_fd) + ") handed to event loop " +
+		           su::to_string(loop->_loop_id));
 		return;
 	}
 
-	// TODO: error checks
 	Connection *conn = addConnection(client_fd, sc);
 
-	if (!epollManage(EPOLL_CTL_ADD, client_fd, EPOLLIN)) {
+	if (!epollManage(EPOLL_CTL_ADD, client_fd, clientEvents(EPOLLIN))) {
+		conn->keep_persistent_connection = false;
 		closeConnection(conn);
+		return;
 	}
 
 	_lggr.info("New connection from " + std::string(inet_ntoa(client_addr.sin_addr)) + ":" +
@@ -41,57 +165,93 @@ void WebServer::handleNewConnection(ServerConfig *sc) {
 	           " (fd: " + su::to_string<int>(client_fd) + ")");
 }
 
-Connection *WebServer::addConnection(int client_fd, ServerConfig *sc) {
-	Connection *conn = new Connection(client_fd);
-	// conn->host = host;
-	// conn->port = port;
+Connection *WebServer::addConnection(int client_fd, const ServerConfig *sc) {
+	Connection *conn = _pool.acquire(client_fd);
 	conn->servConfig = sc;
-	_connections[client_fd] = conn;
+	_fds.addClient(client_fd, conn);
+	refreshTimeout(conn);
 
 	_lggr.debug("Added connection tracking for fd: " + su::to_string(client_fd));
 	return conn;
 }
 
-void WebServer::cleanupExpiredConnections() {
-	time_t current_time = getCurrentTime();
+void WebServer::refreshTimeout(Connection *conn) {
+	const ServerConfig *sc = conn->servConfig;
+	Connection::TimeoutKind kind;
+	int seconds;
 
-	if (current_time - _last_cleanup < CLEANUP_INTERVAL) {
+	if (conn->hasPendingOutput()) {
+		kind = Connection::SEND_TIMEOUT;
+		seconds = sc->getSendTimeout();
+	} else if (conn->cgi_fd != -1) {
+		// Nothing to do on the socket until the CGI answers
+		conn->timeout_kind = Connection::CGI_TIMEOUT;
+		_timers.schedule(&conn->timer, conn->cgi_deadline);
 		return;
+	} else if (conn->state == Connection::READING_HEADERS) {
+		if (conn->read_buffer.empty() && conn->request_count > 0)
+			kind = Connection::KEEPALIVE_TIMEOUT;
+		else
+			kind = Connection::HEADER_TIMEOUT;
+		// Counted from the first byte, not from the last read: slow senders do not extend it
+		if (conn->timeout_kind == kind)
+			return;
+		seconds = (kind == Connection::KEEPALIVE_TIMEOUT) ? sc->getKeepaliveTimeout()
+		                                                  : sc->getHeaderTimeout();
+	} else {
+		kind = Connection::BODY_TIMEOUT;
+		seconds = sc->getBodyTimeout();
 	}
 
-	_last_cleanup = current_time;
-
-	std::vector<Connection *> expired;
+	uint64_t deadline = TimerWheel::now() + static_cast<uint64_t>(seconds) * 1000;
+	// A script that hangs must not hold the connection (and the child) forever:
+	// its deadline runs from the fork, whatever the socket is waiting for meanwhile
+	if (conn->cgi_fd != -1 && conn->cgi_deadline < deadline) {
+		kind = Connection::CGI_TIMEOUT;
+		deadline = conn->cgi_deadline;
+	}
+	conn->timeout_kind = kind;
+	_timers.schedule(&conn->timer, deadline);
+}
 
-	// Collect expired connections
-	for (std::map<int, Connection *>::iterator it = _connections.begin(); it != _connections.end();
-	     ++it) {
+int WebServer::nextEpollTimeout() const {
+	int timeout = _timers.nextTimeout(TimerWheel::now());
+	if (timeout < 0 || timeout > MAX_EPOLL_TIMEOUT)
+		return MAX_EPOLL_TIMEOUT;
+	return timeout;
+}
 
-		Connection *conn = it->second;
-		if (conn->isExpired(time(NULL), CONNECTION_TO)) {
-			conn->keep_persistent_connection = false;
-			expired.push_back(conn);
-			_lggr.info("Connection expired for fd: " + su::to_string(conn->fd));
-		}
-	}
+void WebServer::expireTimers() {
+	std::vector<void *> expired;
 
+	_timers.advance(TimerWheel::now(), expired);
 	for (size_t i = 0; i < expired.size(); ++i) {
-		closeConnection(expired[i]);
+		handleConnectionTimeout(static_cast<Connection *>(expired[i]));
 	}
-	expired.clear();
 }
 
-void WebServer::handleConnectionTimeout(int client_fd) {
-	std::map<int, Connection *>::iterator it = _connections.find(client_fd);
-	if (it != _connections.end()) {
-		Connection *conn = it->second;
+void WebServer::handleConnectionTimeout(Connection *conn) {
+	static const char *kinds[] = {"", "header", "body", "keep-alive", "send", "CGI"};
 
-		prepareResponse(conn, Response(408, conn));
+	_lggr.info("Connection timed out for fd: " + su::to_string(conn->fd) + " (" +
+	           kinds[conn->timeout_kind] + " timeout, idle for " +
+	           su::to_string(getCurrentTime() - conn->last_activity) + " seconds)");
 
-		_lggr.info("Connection timed out for fd: " + su::to_string(client_fd) + " (idle for " +
-		           su::to_string(getCurrentTime() - conn->last_activity) + " seconds)");
-		closeConnection(conn);
+	// A request was in progress: tell the client, best effort
+	bool reading = conn->timeout_kind == Connection::BODY_TIMEOUT ||
+	               (conn->timeout_kind == Connection::HEADER_TIMEOUT && !conn->read_buffer.empty());
+	if (reading && !conn->response_ready && !conn->hasPendingOutput()) {
+		prepareResponse(conn, Response(408, conn));
+		sendResponse(conn);
+	} else if (conn->timeout_kind == Connection::CGI_TIMEOUT) {
+		abortCGI(conn);
+		prepareResponse(conn, Response(504, conn));
+		sendResponse(conn);
 	}
+
+	conn->timeout_kind = Connection::NO_TIMEOUT;
+	conn->keep_persistent_connection = false;
+	closeConnection(conn);
 }
 
 void WebServer::closeConnection(Connection *conn) {
@@ -105,12 +265,16 @@ void WebServer::closeConnection(Connection *conn) {
 	}
 	_lggr.debug("Closing connection for fd: " + su::to_string(conn->fd));
 
+	_timers.cancel(&conn->timer);
+	if (_fds.connection(conn->fd) == conn) {
+		_fds.remove(conn->fd);
+		if (_owner)
+			__sync_fetch_and_sub(&_load, 1);
+	}
+	_io_ready.erase(conn->fd);
+	abortCGI(conn);
 	epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
 	close(conn->fd);
-
-	std::map<int, Connection *>::iterator it = _connections.find(conn->fd);
-	if (it != _connections.end()) {
-		_connections.erase(conn->fd);
-	}
 	_lggr.debug("Connection cleanup completed for fd: " + su::to_string(conn->fd));
+	_pool.release(conn);
 }
@@ -14,14 +14,15 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/MimeTypes.hpp"
 
 // Serving the index file or listing if possible
 Response WebServer::handleDirectoryRequest(Connection *conn, const std::string &fullDirPath) {
 	_lggr.debug("Handling directory request: " + fullDirPath);
 
 	// Try to serve index file
-	if (!conn->locConfig->index.empty()) {
-		std::string fullIndexPath = fullDirPath + conn->locConfig->index;
+	if (!conn->ctx.location->index.empty()) {
+		std::string fullIndexPath = fullDirPath + conn->ctx.location->index;
 		_lggr.debug("Trying index file: " + fullIndexPath);
 		if (checkFileType(fullIndexPath.c_str()) == ISREG) {
 			_lggr.debug("Found index file, serving: " + fullIndexPath);
@@ -30,7 +31,7 @@ Response WebServer::handleDirectoryRequest(Connection *conn, const std::string &
 	}
 
 	// Handle autoindex
-	if (conn->locConfig->autoindex) {
+	if (conn->ctx.location->autoindex) {
 		_lggr.debug("Autoindex on, generating directory listing");
 		return generateDirectoryListing(conn, fullDirPath);
 	}
@@ -88,28 +89,7 @@ Response WebServer::handleReturnDirective(Connection *conn, uint16_t code, std::
 }
 
 std::string WebServer::detectContentType(const std::string &path) {
-
-	std::map<std::string, std::string> cTypes;
-	cTypes[".css"] = "text/css";
-	cTypes[".js"] = "application/javascript";
-	cTypes[".html"] = "text/html";
-	cTypes[".htm"] = "text/html";
-	cTypes[".json"] = "application/json";
-	cTypes[".png"] = "image/png";
-	cTypes[".jpg"] = "image/jpeg";
-	cTypes[".jpeg"] = "image/jpeg";
-	cTypes[".gif"] = "image/gif";
-	cTypes[".svg"] = "image/svg+xml";
-	cTypes[".ico"] = "image/x-icon";
-	cTypes[".txt"] = "text/plain";
-	cTypes[".pdf"] = "application/pdf";
-	cTypes[".zip"] = "application/zip";
-
-	std::string ext = getExtension(path);
-	std::map<std::string, std::string>::const_iterator it = cTypes.find(ext);
-	if (it != cTypes.end())
-		return it->second;
-	return "application/octet-stream"; // default binary stream
+	return mimeType(path).type;
 }
 
 std::string WebServer::getExtension(const std::string &path) {
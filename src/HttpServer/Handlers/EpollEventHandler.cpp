@@ -11,48 +11,55 @@ void WebServer::processEpollEvents(const struct epoll_event *events, int event_c
 		_lggr.debug("Epoll event on fd=" + su::to_string(fd) + " (" +
 		            describeEpollEvents(event_mask) + ")");
 
-		if (isListeningSocket(fd)) {
-			// TODO: NULL check
-			ServerConfig *sc = ServerConfig::find(_confs, fd);
-			handleNewConnection(sc);
-		} else if (isCGIFd(fd)) {
-			handleCGIOutput(fd);
-		} else {
+		const FdTable::Slot &slot = _fds[fd];
+		switch (slot.kind) {
+		case FdTable::CLIENT:
 			handleClientEvent(fd, event_mask);
+			break;
+		case FdTable::LISTENER:
+			handleNewConnection(slot.server);
+			break;
+		case FdTable::CGI_OUTPUT:
+			handleCGIOutput(fd);
+			break;
+		case FdTable::WAKEUP:
+			drainHandoffQueue();
+			break;
+		default:
+			_lggr.debug("Ignoring event for unknown fd: " + su::to_string(fd));
 		}
 	}
 }
 
-bool WebServer::isListeningSocket(int fd) const {
-	for (std::vector<ServerConfig>::const_iterator it = _confs.begin(); it != _confs.end(); ++it) {
-		if (fd == it->getServerFD()) {
-			return true;
-		}
-	}
-	return false;
-}
-
 void WebServer::handleClientEvent(int fd, uint32_t event_mask) {
-	std::map<int, Connection *>::iterator conn_it = _connections.find(fd);
-	if (conn_it != _connections.end()) {
-		Connection *conn = conn_it->second;
+	Connection *conn = _fds.connection(fd);
+	if (conn) {
 		if (event_mask & EPOLLIN) {
 			handleClientRecv(conn);
+			if (!_fds.connection(fd))
+				return;
 		}
 		if (event_mask & EPOLLOUT) {
-			if (conn->response_ready)
-				sendResponse(conn);
-			if (!conn->keep_persistent_connection)
+			if (conn->hasPendingOutput()) {
+				if (!sendResponse(conn)) {
+					_lggr.error("send error for fd " + su::to_string(fd) + ": " + strerror(errno));
+					conn->keep_persistent_connection = false;
+					closeConnection(conn);
+					return;
+				}
+			}
+			if (!conn->keep_persistent_connection && !conn->hasPendingOutput()) {
 				closeConnection(conn);
+				return;
+			}
 		}
 		if (event_mask & (EPOLLERR | EPOLLHUP)) {
 			_lggr.error("Error/hangup event for fd: " + su::to_string(fd));
+			conn->keep_persistent_connection = false;
 			closeConnection(conn);
+			return;
 		}
-		if (event_mask & (EPOLLERR | EPOLLHUP)) {
-			_lggr.error("Error/hangup event for fd: " + su::to_string(fd));
-			closeConnection(conn);
-		}
+		refreshTimeout(conn);
 	} else {
 		_lggr.debug("Ignoring event for unknown fd: " + su::to_string(fd));
 	}
@@ -62,23 +69,54 @@ void WebServer::handleClientRecv(Connection *conn) {
 	_lggr.debug("Updated last activity for FD " + su::to_string(conn->fd));
 	conn->updateActivity();
 
-	char buffer[BUFFER_SIZE];
-
-	ssize_t bytes_read = receiveData(conn->fd, buffer, sizeof(buffer) - 1);
-
-	if (bytes_read > 0) {
-		if (!processReceivedData(conn, buffer, bytes_read)) {
+	// Level-triggered: one recv, epoll reports the socket again if data is left.
+	// Edge-triggered: drain until EAGAIN, but at most IO_BUDGET reads per wakeup.
+	int budget = _global.isEdgeTriggered() ? IO_BUDGET : 1;
+	int requests = conn->request_count;
+
+	while (budget-- > 0) {
+		// Straight into the connection buffer, after the bytes not consumed yet
+		char *tail = conn->read_buffer.prepare(BUFFER_SIZE);
+		ssize_t bytes_read = receiveData(conn->fd, tail, BUFFER_SIZE);
+
+		if (bytes_read > 0) {
+			conn->read_buffer.commit(bytes_read);
+			if (!processReceivedData(conn)) {
+				return;
+			}
+			// A request was completed: the connection switched to writing
+			if (conn->hasPendingOutput() || conn->request_count != requests) {
+				return;
+			}
+		} else if (bytes_read == 0) {
+			_lggr.warn("Client (fd: " + su::to_string(conn->fd) + ") closed connection");
+			conn->keep_persistent_connection = false;
+			closeConnection(conn);
+			return;
+		} else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+			return;
+		} else {
+			_lggr.error("recv error for fd " + su::to_string(conn->fd) + ": " + strerror(errno));
+			conn->keep_persistent_connection = false;
+			closeConnection(conn);
 			return;
 		}
-	} else if (bytes_read == 0) {
-		_lggr.warn("Client (fd: " + su::to_string(conn->fd) + ") closed connection");
-		conn->keep_persistent_connection = false;
-		closeConnection(conn);
-		return;
-	} else if (bytes_read < 0) {
-		_lggr.error("recv error for fd " + su::to_string(conn->fd) + ": " + strerror(errno));
-		closeConnection(conn);
-		return;
+	}
+	// Budget used up before EAGAIN: no new edge will come, serve it again next iteration
+	if (_global.isEdgeTriggered())
+		_io_ready.insert(conn->fd);
+}
+
+void WebServer::processReadyConnections() {
+	std::set<int> ready;
+	ready.swap(_io_ready);
+
+	for (std::set<int>::iterator it = ready.begin(); it != ready.end(); ++it) {
+		Connection *conn = _fds.connection(*it);
+		if (!conn)
+			continue;
+		bool writing = conn->hasPendingOutput();
+		handleClientEvent(*it, writing ? EPOLLOUT : EPOLLIN);
 	}
 }
 
@@ -88,64 +126,53 @@ ssize_t WebServer::receiveData(int client_fd, char *buffer, size_t buffer_size)
 
 	_lggr.logWithPrefix(Logger::DEBUG, "recv", "Bytes received: " + su::to_string(bytes_read));
 	if (bytes_read > 0) {
-		buffer[bytes_read] = '\0';
+		_lggr.logWithPrefix(Logger::DEBUG, "recv", "Data: " + std::string(buffer, bytes_read));
 	}
 
-	_lggr.logWithPrefix(Logger::DEBUG, "recv", "Data: " + std::string(buffer));
-
 	return bytes_read;
 }
 
-bool WebServer::processReceivedData(Connection *conn, const char *buffer, ssize_t bytes_read) {
-	static int i = 0;
-
-	if (conn->state == Connection::READING_HEADERS) {
-		conn->read_buffer += std::string(buffer, bytes_read);
-		std::cerr << i++ << " calls of processReceivedData (HEADERS)" << std::endl;
-	} else if (conn->state == Connection::READING_BODY) {
-		conn->body_data.insert(conn->body_data.end(),
-		                       reinterpret_cast<const unsigned char *>(buffer),
-		                       reinterpret_cast<const unsigned char *>(buffer + bytes_read));
-		conn->body_bytes_read += bytes_read;
-
-		std::cerr << i++ << " calls of processReceivedData (BODY)" << std::endl;
-		std::cerr << "Body data size: " << conn->body_data.size() << " bytes" << std::endl;
-
-		_lggr.debug("Read " + su::to_string(conn->body_bytes_read) + " bytes of body so far");
-	} else {
-		// For chunked data and other states, keep existing behavior
-		conn->read_buffer += std::string(buffer, bytes_read);
-		if (conn->state == Connection::READING_BODY) {
-			conn->body_bytes_read += bytes_read;
-		}
-		std::cerr << i++ << " calls of processReceivedData (OTHER)" << std::endl;
-	}
-
-	_lggr.debug("Checking if request was completed");
-	if (isRequestComplete(conn)) {
-		if (!epollManage(EPOLL_CTL_MOD, conn->fd, EPOLLOUT)) {
-			return false;
+bool WebServer::processReceivedData(Connection *conn) {
+	const ServerConfig *sc = conn->getServerConfig();
+
+	// Pipelining: every complete request in the buffer is answered in turn. A CGI
+	// answers asynchronously, so the requests behind it wait until it is done.
+	while (conn->cgi_fd == -1) {
+		_lggr.debug("Checking if request was completed");
+		bool complete = isRequestComplete(conn);
+		// Only an interim 100 Continue was queued: the chunks may already be buffered
+		if (complete && conn->state == Connection::CONTINUE_SENT)
+			complete = isRequestComplete(conn);
+
+		if (!complete) {
+			if (conn->state == Connection::READING_BODY && !sc->infiniteBodySize() &&
+			    conn->body_bytes_read > sc->getMaxBodySize()) {
+				_lggr.debug("Request body exceeds size limit");
+				handleRequestTooLarge(conn, conn->body_bytes_read);
+			}
+			break;
 		}
 		_lggr.debug("Request was completed");
-		if (conn->chunked && conn->state == Connection::CONTINUE_SENT) {
-			return true;
-		}
-		if (!conn->getServerConfig()->infiniteBodySize() &&
-		    conn->body_bytes_read > conn->getServerConfig()->getMaxBodySize()) {
+		if (!sc->infiniteBodySize() && conn->body_bytes_read > sc->getMaxBodySize()) {
 			_lggr.debug("Request is too large");
-			handleRequestTooLarge(conn, bytes_read);
-			return false;
+			handleRequestTooLarge(conn, conn->body_bytes_read);
+			break;
 		}
 
-		return handleCompleteRequest(conn);
+		handleCompleteRequest(conn);
+		if (!conn->keep_persistent_connection || conn->read_buffer.empty())
+			break;
 	}
 
-	if (conn->state == Connection::READING_BODY && !conn->getServerConfig()->infiniteBodySize() &&
-	    conn->body_bytes_read > conn->getServerConfig()->getMaxBodySize()) {
-		_lggr.debug("Request body exceeds size limit");
-		handleRequestTooLarge(conn, bytes_read);
-		return false;
-	}
+	return updateClientEvents(conn);
+}
 
+bool WebServer::updateClientEvents(Connection *conn) {
+	uint32_t events = conn->hasPendingOutput() ? EPOLLOUT : EPOLLIN;
+	if (events == conn->epoll_events)
+		return true;
+	if (!epollManage(EPOLL_CTL_MOD, conn->fd, clientEvents(events)))
+		return false;
+	conn->epoll_events = events;
 	return true;
 }
@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   EventLoops.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/19 09:41:12 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/19 09:41:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+
+bool WebServer::startEventLoops() {
+	int threads = _global.getWorkerThreads();
+	if (threads <= 1)
+		return true;
+
+	// Loop threads inherit this mask: SIGINT/SIGTERM/SIGUSR1 are only handled by
+	// the acceptor thread, the loops notice the cleared _running flag on their own
+	sigset_t blocked, previous;
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	sigaddset(&blocked, SIGTERM);
+	sigaddset(&blocked, SIGUSR1);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+
+	bool ok = true;
+	for (int i = 0; i < threads && ok; ++i) {
+		WebServer *loop = new WebServer(this, i);
+
+		ok = loop->createEpollInstance();
+		if (ok) {
+			loop->_handoff_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+			if (loop->_handoff_fd == -1)
+				_lggr.error("Failed to create eventfd for event loop " + su::to_string(i) + ": " +
+				            std::string(strerror(errno)));
+			ok = loop->_handoff_fd != -1 && loop->epollManage(EPOLL_CTL_ADD, loop->_handoff_fd, EPOLLIN);
+			if (ok)
+				loop->_fds.addWakeup(loop->_handoff_fd);
+		}
+		if (ok) {
+			int err = pthread_create(&loop->_thread, NULL, &WebServer::eventLoopMain, loop);
+			if (err != 0) {
+				_lggr.error("Failed to start event loop " + su::to_string(i) + ": " +
+				            std::string(strerror(err)));
+				ok = false;
+			}
+		}
+		if (!ok) {
+			delete loop;
+			break;
+		}
+		_loops.push_back(loop);
+	}
+
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+	if (!ok) {
+		_running = false;
+		stopEventLoops();
+		return false;
+	}
+	_lggr.info("Started " + su::to_string(threads) + " event loops");
+	return true;
+}
+
+void WebServer::stopEventLoops() {
+	uint64_t one = 1;
+
+	// Wake the loops so they do not wait for the epoll timeout
+	for (size_t i = 0; i < _loops.size(); ++i) {
+		if (write(_loops[i]->_handoff_fd, &one, sizeof(one)) == -1)
+			_lggr.debug("Could not wake event loop " + su::to_string(i));
+	}
+	for (size_t i = 0; i < _loops.size(); ++i) {
+		pthread_join(_loops[i]->_thread, NULL);
+		delete _loops[i];
+	}
+	if (!_loops.empty())
+		_lggr.info("Stopped " + su::to_string(_loops.size()) + " event loops");
+	_loops.clear();
+}
+
+void *WebServer::eventLoopMain(void *arg) {
+	WebServer *loop = static_cast<WebServer *>(arg);
+
+	loop->_lggr.debug("Event loop " + su::to_string(loop->_loop_id) + " running");
+	loop->runEventLoop();
+	return NULL;
+}
+
+WebServer *WebServer::pickEventLoop() {
+	size_t n = _loops.size();
+	size_t best = _next_loop % n;
+	int best_load = __sync_fetch_and_add(&_loops[best]->_load, 0);
+
+	for (size_t i = 1; i < n && best_load > 0; ++i) {
+		size_t idx = (_next_loop + i) % n;
+		int load = __sync_fetch_and_add(&_loops[idx]->_load, 0);
+		if (load < best_load) {
+			best = idx;
+			best_load = load;
+		}
+	}
+	_next_loop = best + 1;
+	return _loops[best];
+}
+
+void WebServer::handOff(int client_fd, const ServerConfig *sc) {
+	uint64_t one = 1;
+
+	pthread_mutex_lock(&_handoff_lock);
+	_handoff_queue.push_back(std::make_pair(client_fd, sc));
+	pthread_mutex_unlock(&_handoff_lock);
+	__sync_fetch_and_add(&_load, 1);
+
+	if (write(_handoff_fd, &one, sizeof(one)) == -1 && errno != EAGAIN)
+		_lggr.error("Failed to wake event loop " + su::to_string(_loop_id) + ": " +
+		            std::string(strerror(errno)));
+}
+
+void WebServer::drainHandoffQueue() {
+	uint64_t count;
+	std::deque<std::pair<int, const ServerConfig *> > pending;
+
+	if (read(_handoff_fd, &count, sizeof(count)) == -1 && errno != EAGAIN)
+		_lggr.error("Failed to read event loop wakeup: " + std::string(strerror(errno)));
+
+	pthread_mutex_lock(&_handoff_lock);
+	pending.swap(_handoff_queue);
+	pthread_mutex_unlock(&_handoff_lock);
+
+	for (size_t i = 0; i < pending.size(); ++i) {
+		Connection *conn = addConnection(pending[i].first, pending[i].second);
+
+		if (!epollManage(EPOLL_CTL_ADD, conn->fd, clientEvents(EPOLLIN))) {
+			conn->keep_persistent_connection = false;
+			closeConnection(conn);
+		}
+	}
+}
@@ -21,28 +21,43 @@ void WebServer::handleRequestTooLarge(Connection *conn, ssize_t bytes_read) {
 	_lggr.info("Reached max content length for fd: " + su::to_string(conn->fd) + ", " +
 	           su::to_string(bytes_read) + "/" +
 	           su::to_string(conn->getServerConfig()->getMaxBodySize()));
+	// The rest of the body is not read: the connection cannot carry another request
+	conn->keep_persistent_connection = false;
 	prepareResponse(conn, Response(413, conn));
 }
 
 bool WebServer::handleCompleteRequest(Connection *conn) {
 	processRequest(conn);
 
-	_lggr.debug("Request was processed. Read buffer will be cleaned");
-	conn->read_buffer.clear();
+	// Only the headers are left of this request, what follows is the next
+	// pipelined one. Bodies were moved out as they arrived.
+	size_t used = conn->header_length;
+	_lggr.debug("Request was processed, " + su::to_string(used) + " bytes consumed, " +
+	            su::to_string(conn->read_buffer.size() - std::min(used, conn->read_buffer.size())) +
+	            " left in the read buffer");
+	conn->read_buffer.consume(std::min(used, conn->read_buffer.size()));
+	conn->resetForNewRequest();
 	conn->request_count++;
 	conn->updateActivity();
+	// A running CGI completes the request when its output arrives
+	if (conn->cgi_fd == -1)
+		conn->state = Connection::READING_HEADERS;
 	return true; // Continue processing
 }
 
 bool WebServer::handleCGIRequest(ClientRequest &req, Connection *conn) {
 	Logger _lggr;
 
-	CGI *cgi = CGIUtils::createCGI(req, conn->locConfig);
+	CGI *cgi = CGIUtils::createCGI(req, conn->ctx.location, conn->ctx.full_path);
 	if (!cgi)
 		return (false);
-	_cgi_pool[cgi->getOutputFd()] = std::make_pair(cgi, conn);
+	_fds.addCGI(cgi->getOutputFd(), cgi, conn);
+	conn->cgi_fd = cgi->getOutputFd();
+	conn->cgi_deadline =
+	    TimerWheel::now() + static_cast<uint64_t>(conn->servConfig->getSendTimeout()) * 1000;
 	if (!epollManage(EPOLL_CTL_ADD, cgi->getOutputFd(), EPOLLIN)) {
 		_lggr.error("EPollManage for CGI request failed.");
+		abortCGI(conn);
 		return (false);
 	}
 	return (true);
@@ -51,97 +66,54 @@ bool WebServer::handleCGIRequest(ClientRequest &req, Connection *conn) {
 /* Request processing */
 
 bool WebServer::isHeadersComplete(Connection *conn) {
-	std::string temp = conn->read_buffer;
-	size_t header_end = conn->read_buffer.find("\r\n\r\n");
-	if (header_end == std::string::npos) {
+	IOBuffer &in = conn->read_buffer;
+	HeadParser &head = conn->head;
+	// Only the bytes received since the last call are parsed
+	HeadParser::Status status = head.parse(in.data(), in.size());
+	if (status == HeadParser::INCOMPLETE)
 		return false;
+	if (status == HeadParser::FAILED) {
+		// parseRequest() answers with the status code of the failure
+		conn->header_length = in.size();
+		conn->content_length = -1;
+		conn->state = Connection::REQUEST_COMPLETE;
+		return true;
 	}
+	conn->header_length = head.length();
+	conn->body.setMemoryLimit(_global.getClientBodyBufferSize());
 
-	// Headers are complete, check if this is a chunked request
-	std::string headers = conn->read_buffer.substr(0, header_end + 4);
-	std::string headers_lower = su::to_lower(headers);
-
-	if (headers_lower.find("content-length: ") != std::string::npos) {
+	const HeadParser::Header *content_length = head.find(RequestHeaders::CONTENT_LENGTH);
+	const HeadParser::Header *encoding = head.find(RequestHeaders::TRANSFER_ENCODING);
+	if (content_length) {
 		_lggr.debug("Found `Content-Length` header");
-		size_t cl_start = headers_lower.find("content-length: ") + 16;
-		size_t cl_end = headers_lower.find("\r\n", cl_start);
-
-		if (cl_end == std::string::npos) {
-			// TODO: handle malformed header
-			_lggr.error("Malformed header");
-			conn->content_length = -1;
-			conn->state = Connection::REQUEST_COMPLETE;
-			_lggr.logWithPrefix(Logger::ERROR, "BAD REQUEST", "Malformed headers");
-			prepareResponse(conn, Response::badRequest());
-			return true;
-		}
-
-		std::string cl_value = headers.substr(cl_start, cl_end - cl_start);
+		std::string cl_value = HeadParser::str(in.data(), content_length->value);
 
 		char *endptr;
 		long parsed_length = std::strtol(cl_value.c_str(), &endptr, 10);
 
-		if (*endptr != '\0' || parsed_length < 0) {
+		if (cl_value.empty() || *endptr != '\0' || parsed_length < 0) {
 			conn->content_length = -1;
 		} else {
 			conn->content_length = static_cast<ssize_t>(parsed_length);
 		}
 
 		conn->chunked = false;
-		conn->headers_buffer = headers;
-
-		// Handle any body data that came with headers
-		std::string remaining_data = conn->read_buffer.substr(header_end + 4);
-		if (!remaining_data.empty()) {
-			// Store remaining data as binary body data
-			conn->body_data.insert(conn->body_data.end(),
-			                       reinterpret_cast<const unsigned char *>(remaining_data.data()),
-			                       reinterpret_cast<const unsigned char *>(remaining_data.data() +
-			                                                               remaining_data.size()));
-		}
-
-		// Clear the read_buffer since we've processed headers and moved body to body_data
-		conn->read_buffer.clear();
-		conn->read_buffer = temp;
-
-		conn->body_bytes_read = conn->body_data.size();
 		conn->state = Connection::READING_BODY;
+		return receiveBody(conn);
 
-		if (static_cast<ssize_t>(conn->body_bytes_read) >= conn->content_length) {
-			conn->state = Connection::REQUEST_COMPLETE;
-			return true;
-		}
-
-		return false;
-
-	} else if (headers_lower.find("transfer-encoding: chunked") != std::string::npos) {
+	} else if (encoding && HeadParser::equals(in.data(), encoding->value, "chunked")) {
 		conn->chunked = true;
-		// conn->state = Connection::READING_CHUNK_SIZE;
-		conn->headers_buffer = headers;
+		conn->chunk_size = 0;
+		conn->chunk_bytes_read = 0;
+		const HeadParser::Header *expect = head.find(RequestHeaders::EXPECT);
 
-		if (headers_lower.find("expect: 100-continue") != std::string::npos) {
+		if (expect && HeadParser::equals(in.data(), expect->value, "100-continue")) {
 			prepareResponse(conn, Response::continue_());
-
 			conn->state = Connection::CONTINUE_SENT;
-
-			conn->read_buffer.clear();
-
-			conn->chunk_size = 0;
-			conn->chunk_bytes_read = 0;
-			conn->chunk_data.clear();
-
 			return true;
-		} else {
-			conn->state = Connection::READING_CHUNK_SIZE;
-
-			conn->read_buffer = conn->read_buffer.substr(header_end + 4);
-
-			conn->chunk_size = 0;
-			conn->chunk_bytes_read = 0;
-			conn->chunk_data.clear();
-
-			return processChunkSize(conn);
 		}
+		conn->state = Connection::READING_CHUNK_SIZE;
+		return receiveChunks(conn);
 	} else {
 		conn->chunked = false;
 		conn->state = Connection::REQUEST_COMPLETE;
@@ -150,6 +122,35 @@ bool WebServer::isHeadersComplete(Connection *conn) {
 	return false;
 }
 
+// The body is moved out of read_buffer as it arrives, so that the buffer stays
+// small whatever its size. The headers stay at the front of read_buffer (the
+// parser reads them in place), what follows the body too: it is the start of
+// the next pipelined request.
+bool WebServer::receiveBody(Connection *conn) {
+	IOBuffer &in = conn->read_buffer;
+	size_t expected = conn->content_length > 0 ? conn->content_length : 0;
+	size_t n = std::min(in.size() - conn->header_length, expected - conn->body.size());
+
+	if (n > 0) {
+		if (!conn->body.append(in.data() + conn->header_length, n)) {
+			_lggr.error("Could not store the request body of fd " + su::to_string(conn->fd) +
+			            ": " + strerror(errno));
+			conn->keep_persistent_connection = false;
+			prepareResponse(conn, Response::internalServerError(conn));
+			return false;
+		}
+		in.erase(conn->header_length, n);
+	}
+	conn->body_bytes_read = conn->body.size();
+	_lggr.debug(su::to_string(expected - conn->body_bytes_read) + " bytes left to receive");
+	if (conn->body_bytes_read < expected)
+		return false;
+	_lggr.debug("Read full content-length: " + su::to_string(conn->body_bytes_read) +
+	            " bytes received");
+	conn->state = Connection::REQUEST_COMPLETE;
+	return true;
+}
+
 bool WebServer::isRequestComplete(Connection *conn) {
 	switch (conn->state) {
 	case Connection::READING_HEADERS:
@@ -158,37 +159,20 @@ bool WebServer::isRequestComplete(Connection *conn) {
 
 	case Connection::READING_BODY:
 		_lggr.debug("isRequestComplete->READING_BODY");
-		_lggr.debug(
-		    su::to_string(conn->content_length - static_cast<ssize_t>(conn->body_data.size())) +
-		    " bytes left to receive");
-		if (static_cast<ssize_t>(conn->body_data.size()) >= conn->content_length) {
-			_lggr.debug("Read full content-length: " + su::to_string(conn->body_data.size()) +
-			            " bytes received");
-			conn->state = Connection::REQUEST_COMPLETE;
-			reconstructRequest(conn);
-			return true;
-		}
-		return false;
+		return receiveBody(conn);
 
 	case Connection::CONTINUE_SENT:
 		_lggr.debug("isRequestComplete->CONTINUE_SENT");
 		conn->state = Connection::READING_CHUNK_SIZE;
-		return processChunkSize(conn);
+		return receiveChunks(conn);
 
 	case Connection::READING_CHUNK_SIZE:
-		_lggr.debug("isRequestComplete->READING_CHUNK_SIZE");
-		return processChunkSize(conn);
-
 	case Connection::READING_CHUNK_DATA:
-		_lggr.debug("isRequestComplete->READING_CHUNK_DATA");
-		return processChunkData(conn);
-
 	case Connection::READING_TRAILER:
-		_lggr.debug("isRequestComplete->READING_TRAILER");
-		return processTrailer(conn);
+		_lggr.debug("isRequestComplete->" + conn->stateToString(conn->state));
+		return receiveChunks(conn);
 
 	case Connection::REQUEST_COMPLETE:
-	case Connection::CHUNK_COMPLETE:
 		_lggr.debug("isRequestComplete->REQUEST_COMPLETE");
 		return true;
 
@@ -200,9 +184,15 @@ bool WebServer::isRequestComplete(Connection *conn) {
 
 bool WebServer::parseRequest(Connection *conn, ClientRequest &req) {
 	_lggr.debug("Parsing request: " + conn->toString());
-	if (!RequestParsingUtils::parseRequest(conn->read_buffer, req)) {
+	// The headers are parsed in place, at the front of read_buffer; the body,
+	// decoded if it was chunked, is in conn->body
+	bool parsed = RequestParsingUtils::parseRequest(conn->head, conn->read_buffer.data(),
+	                                                conn->body.size(), req);
+	if (!parsed) {
 		_lggr.error("Parsing of the request failed.");
 		_lggr.debug("FD " + su::to_string(conn->fd) + " " + conn->toString());
+		// Where the next request starts is not reliable anymore
+		conn->keep_persistent_connection = false;
 		prepareResponse(conn, Response(g_error_status, conn));
 		// closeConnection(conn);
 		return false;
@@ -215,6 +205,7 @@ void WebServer::processRequest(Connection *conn) {
 
 	ClientRequest req;
 	req.clfd = conn->fd;
+	req.body = &conn->body;
 
 	if (!parseRequest(conn, req))
 		return;
@@ -225,31 +216,8 @@ void WebServer::processRequest(Connection *conn) {
 
 	// RFC 2068 Section 8.1 -- presistent connection unless client or server sets connection header
 	// to 'close' -- indicating that the socket for this connection may be closed
-	if (req.headers.find("connection") != req.headers.end()) {
-		if (req.headers["connection"] == "close") {
-			conn->keep_persistent_connection = false;
-		}
-	}
-
-	if (req.chunked_encoding && conn->state == Connection::READING_HEADERS) {
-		// Accept chunked requests sequence
-		_lggr.debug("Accepting a chunked request");
-		conn->state = Connection::READING_CHUNK_SIZE;
-		conn->chunked = true;
-		prepareResponse(conn, Response::continue_());
-		return;
-	}
-
-	// TODO: this part breaks the req struct for some reason
-	//       can't debug on my own :(
-	if (req.chunked_encoding && conn->state == Connection::CHUNK_COMPLETE) {
-		_lggr.debug("Chunked request completed!");
-		_lggr.debug("Parsing complete chunked request");
-		if (!parseRequest(conn, req))
-			return;
-		_lggr.debug("Chunked request parsed successfully");
-		_lggr.debug(conn->toString());
-		_lggr.debug(req.toString());
+	if (req.headers.value(RequestHeaders::CONNECTION) == "close") {
+		conn->keep_persistent_connection = false;
 	}
 
 	_lggr.debug("FD " + su::to_string(req.clfd) + " ClientRequest {" + req.toString() + "}");
@@ -262,68 +230,112 @@ void WebServer::processRequest(Connection *conn) {
 	processValidRequest(req, conn);
 }
 
+// realpath() of a path that does not exist fails: its ".." segments are
+// followed by hand, a missing path must not leave the root either
+static bool leavesRoot(const std::string &path) {
+	int depth = 0;
+	size_t start = 0;
+	while (start < path.size()) {
+		size_t end = path.find('/', start);
+		if (end == std::string::npos)
+			end = path.size();
+		std::string segment = path.substr(start, end - start);
+		if (segment == "..")
+			--depth;
+		else if (!segment.empty() && segment != ".")
+			++depth;
+		if (depth < 0)
+			return true;
+		start = end + 1;
+	}
+	return false;
+}
 
 bool WebServer::setupRequestContext(ClientRequest &req, Connection *conn) {
 
-	// initialize the correct locConfig // default "/"
-	LocConfig *match = findBestMatch(req.uri, conn->servConfig->getLocations());
+	// initialize the correct location // default "/"
+	conn->ctx.clear();
+	const LocConfig *match = findBestMatch(req.uri, *conn->servConfig, conn->ctx.exact);
 	if (!match) {
 		_lggr.error("[Resp] No matched location for : " + req.uri);
 		prepareResponse(conn, Response::internalServerError(conn));
 		return false;
 	}
-	conn->locConfig = match; 
-	conn->locConfig->setFullPath("");
-	_lggr.debug("[Resp] Matched location : " + conn->locConfig->path);
+	conn->ctx.location = match; 
+	_lggr.debug("[Resp] Matched location : " + conn->ctx.location->path);
 
 	// normalisation
-	std::string full_path = buildFullPath(req.path, conn->locConfig);
-	std::string root_full_path = buildFullPath("", conn->locConfig);
-	char resolved[PATH_MAX];
-	realpath(full_path.c_str(), resolved);
-	std::string normal_full_path(resolved);
-	if (su::back(full_path) == '/')
+	std::string full_path = buildFullPath(req.path, conn->ctx.location);
+	std::string root_full_path = buildFullPath("", conn->ctx.location);
+	std::string normal_full_path;
+	bool missing;
+	if (const CachedFile *file = _files.lookup(full_path)) {
+		normal_full_path = file->resolved;
+		missing = false;
+	} else if (_files.enabled() && (errno == ENOENT || errno == ENOTDIR)) {
+		missing = true; // known to be missing, no realpath()
+	} else {
+		char resolved[PATH_MAX];
+		missing = !realpath(full_path.c_str(), resolved);
+		if (missing && errno == EACCES) {
+			prepareResponse(conn, Response::forbidden(conn));
+			return false;
+		}
+		if (missing && errno != ENOENT && errno != ENOTDIR) {
+			prepareResponse(conn, Response::internalServerError(conn));
+			return false;
+		}
+		if (!missing)
+			normal_full_path = resolved;
+	}
+	// Nothing to resolve for a missing path: checkFileType() answers 404, once
+	// a return directive had its chance
+	if (missing)
+		normal_full_path = full_path;
+	else if (su::back(full_path) == '/')
 		normal_full_path += "/";
 	_lggr.debug("[Resp] Normalized full path : " + normal_full_path);
 	_lggr.debug("[Resp] Root full path : " + root_full_path);
 
 	// std::string temp_full_path = normal_full_path + "/";
 
-	if (normal_full_path.compare(0, root_full_path.size(), root_full_path) != 0) {
+	if (normal_full_path.compare(0, root_full_path.size(), root_full_path) != 0 ||
+	    (missing && leavesRoot(req.path))) {
 		_lggr.error("Resolved path is trying to access parent directory: " + normal_full_path);
 		prepareResponse(conn, Response::forbidden(conn));
 		return false;
 	}
 	
-	// this should maybe be in the connection info, not in the locConfig
-	conn->locConfig->setFullPath(normal_full_path);
+	// per request: the configuration is shared read-only between event-loop threads
+	conn->ctx.full_path = normal_full_path;
 	return true;
 }
 
 void WebServer::processValidRequest(ClientRequest &req, Connection *conn) {
 		
-	const std::string& full_path = conn->locConfig->getFullPath();
-	_lggr.debug("[Resp] The matched location is an exact match: " + su::to_string(conn->locConfig->is_exact_()));
+	const std::string& full_path = conn->ctx.full_path;
+	_lggr.debug("[Resp] The matched location is an exact match: " + su::to_string(conn->ctx.exact));
 
 	// check if RETURN directive in the matched location
-	if (conn->locConfig->hasReturn() && conn->locConfig->is_exact_()) {
+	if (conn->ctx.location->hasReturn() && conn->ctx.exact) {
 		_lggr.debug("[Resp] The matched location has a return directive.");
-		uint16_t code = conn->locConfig->return_code;
-		std::string target = conn->locConfig->return_target;
+		uint16_t code = conn->ctx.location->return_code;
+		std::string target = conn->ctx.location->return_target;
 		prepareResponse(conn, respReturnDirective(conn, code, target));
 		return;
 	}
 	
 	// method allowed?
-	if (!conn->locConfig->hasMethod(req.method)) {
+	if (!conn->ctx.location->hasMethod(req.method)) {
 		_lggr.warn("[Resp] Method " + req.method + " is not allowed for location " +
-		          conn->locConfig->path);
-		prepareResponse(conn, Response::methodNotAllowed(conn, conn->locConfig->getAllowedMethodsString()));
+		          conn->ctx.location->path);
+		prepareResponse(conn, Response::methodNotAllowed(conn, conn->ctx.location->getAllowedMethodsString()));
 		return;
 	}
 	
 	// File system check 
-	FileType file_type = checkFileType(full_path);
+	conn->ctx.file_type = checkFileType(full_path);
+	FileType file_type = conn->ctx.file_type;
 
 	// File system errors
 	if (!handleFileSystemErrors(file_type, full_path, conn))
@@ -345,27 +357,27 @@ void WebServer::processValidRequest(ClientRequest &req, Connection *conn) {
 
 void WebServer::handleDirectoryRequest(ClientRequest &req, Connection *conn, bool end_slash) {
 
-	const std::string full_path =  conn->locConfig->getFullPath();
+	const std::string full_path =  conn->ctx.full_path;
 	
 	_lggr.debug("Directory request: " + full_path);
-	if (!end_slash ) {  //&& !conn->locConfig->is_exact_()
+	if (!end_slash ) {  //&& !conn->ctx.exact
 		_lggr.debug("Directory request without trailing slash, redirecting: " + req.uri);
 		std::string redirectPath = req.uri + "/";
 		prepareResponse(conn, respReturnDirective(conn, 301, redirectPath));
 		return;
 	} else {
-		prepareResponse(conn, respDirectoryRequest(conn, full_path));
+		prepareResponse(conn, respDirectoryRequest(req, conn, full_path));
 		return;
 	}
 }
 
 void  WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool end_slash) {
 
-	const std::string full_path =  conn->locConfig->getFullPath();
+	const std::string full_path =  conn->ctx.full_path;
 	_lggr.debug("File request: " + full_path);
 	
 	// Trailing '/'? Redirect
-	if (end_slash ) { //&& !conn->locConfig->is_exact_()
+	if (end_slash ) { //&& !conn->ctx.exact
 		_lggr.debug("File request with trailing slash, redirecting: " + req.uri);
 		std::string redirectPath = req.uri.substr(0, req.uri.length() - 1);
 		prepareResponse(conn, respReturnDirective(conn, 301, redirectPath));
@@ -374,8 +386,8 @@ void  WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool en
 
 	// HANDLE CGI
 	std::string extension = getExtension(full_path);
-	if (conn->locConfig->acceptExtension(extension)) {
-		std::string interpreter = conn->locConfig->getExtensionPath(extension);
+	if (conn->ctx.location->acceptExtension(extension)) {
+		std::string interpreter = conn->ctx.location->getExtensionPath(extension);
 		_lggr.debug("CGI request, interpreter location : " + interpreter);
 		req.extension = extension;
 		if (!handleCGIRequest(req, conn)) {
@@ -388,7 +400,7 @@ void  WebServer::handleFileRequest(ClientRequest &req, Connection *conn, bool en
 	// HANDLE STATIC GET RESPONSE
 	if (req.method == "GET") {
 		_lggr.debug("Static file GET request");
-		prepareResponse(conn, respFileRequest(conn, full_path));
+		prepareResponse(conn, respFileRequest(req, conn, full_path));
 		return;
 	} else {
 		_lggr.debug("Non-GET request for static file - not implemented");
@@ -416,40 +428,3 @@ bool WebServer::handleFileSystemErrors(FileType file_type, const std::string& fu
 	}
 	return true;
 }
-
-bool WebServer::reconstructRequest(Connection *conn) {
-	std::string reconstructed_request;
-
-	std::cout << "            INSIDE RECONSTRUCT\n";
-	if (conn->headers_buffer.empty()) {
-		_lggr.warn("Cannot reconstruct request: headers not available");
-		return false;
-	}
-
-	std::cout << "                                     HEADER BUFFER: " << conn->headers_buffer << std::endl;
-	reconstructed_request = conn->headers_buffer;
-	std::cout << "                                     RECONSTR BUFFER: " << conn->headers_buffer << std::endl;
-
-	if (conn->content_length > 0) {
-		size_t body_size =
-		    std::min(static_cast<size_t>(conn->content_length), conn->body_data.size());
-
-		reconstructed_request.append(reinterpret_cast<const char *>(&conn->body_data[0]),
-		                             body_size);
-
-		_lggr.debug("Reconstructed request with " + su::to_string(body_size) +
-		            " bytes of body data");
-	}
-
-	conn->read_buffer = reconstructed_request;
-
-	size_t headers_end = conn->headers_buffer.size();
-	std::string debug_output =
-	    "Reconstructed request headers:\n" + conn->read_buffer.substr(0, headers_end);
-	if (conn->content_length > 0) {
-		debug_output += "\n[Binary body data: " + su::to_string(conn->body_data.size()) + " bytes]";
-	}
-	_lggr.debug(debug_output);
-
-	return true;
-}
@@ -14,58 +14,108 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/GeneralUtils.hpp"
 
 ssize_t WebServer::prepareResponse(Connection *conn, const Response &resp) {
 	// TODO: some checks if the arguments are fine to work with
 	// TODO: make sure that Response has all required headers set up correctly (e.g. Content-Type,
 	// Content-Length, etc).
 	if (conn->response_ready) {
-		_lggr.error(
-		    "Trying to prepare a response for a connection that is ready to sent another one");
-		_lggr.error("Current response: " + conn->response.toShortString());
+		_lggr.error("Trying to prepare a second response for the current request of fd " +
+		            su::to_string(conn->fd));
 		_lggr.error("Trying to prepare response: " + resp.toShortString());
 		return -1;
 	}
-	_lggr.debug("Saving a response [" + su::to_string(resp.status_code) + "] for fd " +
+	_lggr.debug("Queueing a response [" + su::to_string(resp.status_code) + "] for fd " +
 	            su::to_string(conn->fd));
-	conn->response = resp;
-	conn->response_ready = true;
-	return conn->response.toString().size();
-	// return send(clfd, raw_response.c_str(), raw_response.length(), 0);
+	// The status line is copied from a table and the Date line changes once a
+	// second; both go into storage the connection reuses for every head
+	std::string &head = conn->output.scratch();
+	const std::string &date = _date.line();
+	// A response of the static cache has its headers and body serialized and shared
+	if (resp.cached) {
+		ResponseWriter::appendStatusLine(head, resp.status_code);
+		head += date;
+		size_t size = head.size() + resp.cached->data.size();
+		conn->output.push(head);
+		conn->output.push(resp.cached);
+		conn->response_ready = true;
+		return size;
+	}
+	// Head and a small body in one segment, a larger body in a second one, all
+	// written together by one sendmsg(); the responses of pipelined requests
+	// wait in order behind them
+	resp.writeHead(head, date);
+	size_t size = head.size() + resp.body.size() + resp.body_length;
+	bool inline_body = resp.body_parts.empty() &&
+	                   head.size() + resp.body.size() <= OutputQueue::SPARE_MAX;
+	if (inline_body)
+		head += resp.body;
+	conn->output.push(head);
+	// A multipart/byteranges body alternates part headers and file ranges
+	for (size_t i = 0; i < resp.body_parts.size(); ++i) {
+		const Response::BodyPart &part = resp.body_parts[i];
+		conn->output.append(part.head);
+		if (resp.body_mapped)
+			conn->output.pushMapped(resp.body_file, part.offset, part.length);
+		else
+			conn->output.pushFile(resp.body_file, part.offset, part.length);
+		size += part.head.size() + part.length;
+	}
+	if (!inline_body)
+		conn->output.append(resp.body);
+	// A file body stays on disk and is sent from its descriptor
+	if (resp.body_file && resp.body_length > 0) {
+		if (resp.body_mapped)
+			conn->output.pushMapped(resp.body_file, resp.body_offset, resp.body_length);
+		else
+			conn->output.pushFile(resp.body_file, resp.body_offset, resp.body_length);
+	}
+	// 1xx responses are interim, the final one still has to follow
+	if (resp.status_code >= 200)
+		conn->response_ready = true;
+	return size;
 }
 
 bool WebServer::sendResponse(Connection *conn) {
-	if (!conn->response_ready) {
-		_lggr.error("Response is not ready to be sent back to the client");
-		_lggr.debug("Error for clinet " + conn->toString());
-		return false;
-	}
-	_lggr.debug("Sending response [" + conn->response.toShortString() +
-	            "] back to fd: " + su::to_string(conn->fd));
-	std::string raw_response = conn->response.toString();
-	epollManage(EPOLL_CTL_MOD, conn->fd, EPOLLIN);
-	conn->response.reset();
-	conn->response_ready = false;
-    conn->state = Connection::READING_HEADERS;
-	return send(conn->fd, raw_response.c_str(), raw_response.size(), MSG_NOSIGNAL) != -1;
+	_lggr.debug("Sending " + su::to_string(conn->output.size()) +
+	            " queued bytes to fd: " + su::to_string(conn->fd));
+
+	// Whatever the socket does not take now stays queued until the next EPOLLOUT
+	int budget = _global.isEdgeTriggered() ? IO_BUDGET : 1;
+	while (conn->hasPendingOutput() && budget-- > 0) {
+		if (conn->output.writeTo(conn->fd) == -1) {
+			if (errno == EAGAIN || errno == EWOULDBLOCK)
+				return true;
+			return false;
+		}
+	}
+	if (conn->hasPendingOutput()) {
+		if (_global.isEdgeTriggered())
+			_io_ready.insert(conn->fd);
+		return true;
+	}
+
+	return updateClientEvents(conn);
 }
 
 // Serving the index file or listing if possible
-Response WebServer::respDirectoryRequest(Connection *conn, const std::string &fullDirPath) {
+Response WebServer::respDirectoryRequest(const ClientRequest &req, Connection *conn,
+                                         const std::string &fullDirPath) {
 	_lggr.debug("Handling directory request: " + fullDirPath);
 
 	// Try to serve index file
-	if (!conn->locConfig->index.empty()) {
-		std::string fullIndexPath = fullDirPath + conn->locConfig->index;
+	if (!conn->ctx.location->index.empty()) {
+		std::string fullIndexPath = fullDirPath + conn->ctx.location->index;
 		_lggr.debug("Trying index file: " + fullIndexPath);
 		if (checkFileType(fullIndexPath.c_str()) == ISREG) {
 			_lggr.debug("Found index file, serving: " + fullIndexPath);
-			return respFileRequest(conn, fullIndexPath);
+			return respFileRequest(req, conn, fullIndexPath);
 		}
 	}
 
 	// Handle autoindex
-	if (conn->locConfig->autoindex) {
+	if (conn->ctx.location->autoindex) {
 		_lggr.debug("Autoindex on, generating directory listing");
 		return generateDirectoryListing(conn, fullDirPath);
 	}
@@ -76,24 +126,120 @@ Response WebServer::respDirectoryRequest(Connection *conn, const std::string &fu
 }
 
 // serving the file if found
-Response WebServer::respFileRequest(Connection *conn, const std::string &fullFilePath) {
+Response WebServer::respFileRequest(const ClientRequest &req, Connection *conn,
+                                    const std::string &fullFilePath) {
 	_lggr.debug("Handling file request: " + fullFilePath);
-	// Read file content
-	std::string content = getFileContent(fullFilePath);
-	// this check is redondant as it has already been checked 
-	if (content.empty()) {
-		_lggr.error("Failed to read file: " + fullFilePath);
+	CachedFile *file = acquireFile(fullFilePath);
+	if (!file) {
+		_lggr.error("Failed to open file: " + fullFilePath + ": " + strerror(errno));
+		if (errno == EACCES)
+			return Response::forbidden(conn);
 		return Response::notFound(conn);
 	}
-	// Create response
-	Response resp(200, content);
-	resp.setContentType(detectContentType(fullFilePath));
-	resp.setContentLength(content.length());
-	_lggr.debug("Successfully serving file: " + fullFilePath + " (" +
-	            su::to_string(content.length()) + " bytes)");
+	// A compressed representation is only chosen for a complete response
+	std::string encoding;
+	CachedFile *variant = NULL;
+	if (_global.isGzipStatic() && !file->is_dir && !req.headers.get(RequestHeaders::RANGE))
+		variant = findPrecompressed(req, *file, encoding);
+	Response resp(200);
+	serveFile(req, conn, file, variant, encoding, resp);
+	if (variant)
+		variant->release();
+	file->release(); // resp holds its own reference while the file is sent
 	return resp;
 }
 
+CachedFile *WebServer::acquireFile(const std::string &path) {
+	// Hot files are already open, with their type and ETag worked out; without
+	// the cache the file is opened for this response only
+	if (!_files.enabled())
+		return _files.open(path);
+	CachedFile *file = _files.lookup(path);
+	if (file)
+		file->retain();
+	return file;
+}
+
+void WebServer::serveFile(const ClientRequest &req, Connection *conn, CachedFile *file,
+                          CachedFile *variant, std::string encoding, Response &resp) {
+	if (file->is_dir) {
+		resp = Response::notFound(conn);
+		return;
+	}
+	CachedFile *body = variant ? variant : file;
+	bool gzip = !variant && shouldGzip(req, *file);
+	if (gzip)
+		encoding = "gzip";
+	// Validators come from the cached stat(): a 304 never touches the file.
+	// A body compressed here is only weakly tied to the file's bytes.
+	std::string etag = entityTag(*body);
+	bool stable = etag[0] == '"';
+	if (gzip && stable)
+		etag = "W/" + etag;
+	// With gzip_static any file may have a precompressed sibling, looked up or not
+	bool vary = _global.isGzipStatic() || (_global.isGzip() && file->compressible);
+	if (isNotModified(req, *body, etag)) {
+		_lggr.debug("Not modified: " + body->path);
+		resp = Response(304);
+		resp.setHeader("ETag", etag);
+		resp.setHeader("Last-Modified", httpDate(body->mtime));
+		if (vary)
+			resp.setHeader("Vary", "Accept-Encoding");
+		return;
+	}
+	if (encoding.empty() && respRangeRequest(req, conn, file, etag, resp)) {
+		if (vary)
+			resp.setHeader("Vary", "Accept-Encoding");
+		return;
+	}
+
+	// Only complete responses of files older than a second are worth keeping
+	bool small = _responses.accepts(body->size) && stable;
+	if (small) {
+		if (SharedBuffer *cached = _responses.find(*body, encoding)) {
+			resp.setCachedResponse(cached);
+			return;
+		}
+	}
+	if (gzip && !gzipFile(*file, resp.body)) {
+		gzip = false;
+		encoding.clear();
+		etag = entityTag(*file);
+	}
+	resp.setContentType(file->content_type);
+	resp.setHeader("ETag", etag);
+	resp.setHeader("Last-Modified", httpDate(body->mtime));
+	if (vary)
+		resp.setHeader("Vary", "Accept-Encoding");
+	if (!encoding.empty())
+		resp.setHeader("Content-Encoding", encoding);
+	if (gzip) {
+		resp.setContentLength(resp.body.size());
+		if (small) {
+			std::string headers;
+			resp.writeHeaders(headers);
+			if (SharedBuffer *cached = _responses.insert(*body, headers, resp.body, encoding))
+				resp.setCachedResponse(cached);
+		}
+		_lggr.debug("Serving file: " + file->path + " (" + su::to_string(file->size) +
+		            " bytes, " + su::to_string(resp.body.size()) + " gzipped)");
+		return;
+	}
+	if (encoding.empty())
+		resp.setHeader("Accept-Ranges", "bytes");
+	// Mid-sized files go out of a mapping shared by every request for them,
+	// gathered with the headers in one sendmsg()
+	bool mapped = _global.isMmapSize(body->size) && body->mapping();
+	resp.setBodyFile(body, 0, static_cast<size_t>(body->size), mapped);
+	// Small files are kept as a complete response, shared by the next hits
+	if (small) {
+		std::string headers;
+		resp.writeHeaders(headers);
+		if (SharedBuffer *cached = _responses.insert(*body, headers, encoding))
+			resp.setCachedResponse(cached);
+	}
+	_lggr.debug("Serving file: " + body->path + " (" + su::to_string(body->size) + " bytes)");
+}
 
 Response WebServer::respReturnDirective(Connection *conn, uint16_t code, std::string target) {
 	_lggr.debug("Handling return directive '" + su::to_string(code) + "' to " + target);
@@ -38,22 +38,54 @@ void WebServer::sendCGIResponse(std::string &cgi_output, CGI *cgi, Connection *c
 	Response resp;
 	resp.setStatus(200);
 	resp.version = "HTTP/1.1";
-	resp.setContentType(cgi->extractContentType(cgi_output));
 
-	size_t header_end = cgi_output.find("\n\n");
+	// The CGI headers end with an empty line, "\r\n\r\n" or "\n\n" depending on the script
+	size_t header_end = cgi_output.find("\r\n\r\n");
+	size_t body_start = header_end + 4;
+	size_t lf_end = cgi_output.find("\n\n");
+	if (lf_end != std::string::npos && (header_end == std::string::npos || lf_end < header_end)) {
+		header_end = lf_end;
+		body_start = lf_end + 2;
+	}
+
 	if (header_end != std::string::npos) {
-		// Found header separator, extract body after it
-		resp.body = cgi_output.substr(header_end + 2); // +2 to skip "\n\n"
-		resp.setContentLength(resp.body.length());
+		std::istringstream header_stream(cgi_output.substr(0, header_end));
+		std::string line;
+		bool first = true;
+		while (std::getline(header_stream, line)) {
+			// Non-parsed-header style scripts start with a status line ("HTTP/1.1 404 Not Found")
+			// instead of a Status header
+			if (first && line.compare(0, 7, "HTTP/1.") == 0) {
+				first = false;
+				size_t code_pos = line.find(' ');
+				int code = code_pos == std::string::npos ? 0 : std::atoi(line.c_str() + code_pos);
+				if (code >= 100 && code <= 599)
+					resp.setStatus(static_cast<uint16_t>(code));
+				continue;
+			}
+			first = false;
+			size_t colon_pos = line.find(':');
+			if (colon_pos == std::string::npos)
+				continue;
+			std::string name = su::trim(line.substr(0, colon_pos));
+			std::string value = su::trim(line.substr(colon_pos + 1));
+			std::string lower = su::to_lower(name);
+			if (lower == "status")
+				resp.setStatus(static_cast<uint16_t>(std::atoi(value.c_str())));
+			else if (lower == "content-type")
+				resp.setContentType(value);
+			else if (lower != "content-length")
+				resp.setHeader(name, value);
+		}
+		resp.body = cgi_output.substr(body_start);
 	} else {
 		// No header separator found, treat entire output as body
+		resp.setContentType(cgi->extractContentType(cgi_output));
 		resp.body = cgi_output;
-		resp.setContentLength(cgi_output.length());
 	}
+	resp.setContentLength(resp.body.length());
 
-	std::string raw_response = resp.toString();
-	conn->response_ready = true;
-	send(conn->fd, raw_response.c_str(), raw_response.length(), 0);
+	prepareResponse(conn, resp);
 	cgi->cleanup();
 	delete cgi;
 }
@@ -77,31 +109,56 @@ void WebServer::normalResponse(CGI *cgi, Connection *conn) {
 		logger.logWithPrefix(Logger::ERROR, "CGI", "Error reading from CGI script");
 		close(cgi->getOutputFd());
 		waitpid(cgi->getPid(), NULL, 0);
+		delete cgi;
+		prepareResponse(conn, Response::internalServerError(conn));
 		return;
 	}
 	print_cgi_response(cgi_output);
-	//sendCGIResponse(cgi_output, cgi, conn);
-	conn->response_ready = true;
-	send(conn->fd, cgi_output.c_str(), cgi_output.length(), 0);
+	// Queued behind the responses of the requests that came before it
+	sendCGIResponse(cgi_output, cgi, conn);
+}
+
+void WebServer::abortCGI(Connection *conn) {
+	if (conn->cgi_fd == -1)
+		return;
+
+	int fd = conn->cgi_fd;
+	CGI *cgi = _fds[fd].cgi;
+	conn->cgi_fd = -1;
+	_fds.remove(fd);
+	epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	if (!cgi) {
+		close(fd);
+		return;
+	}
+	_lggr.debug("Aborting CGI (pid " + su::to_string(cgi->getPid()) + ") of fd " +
+	            su::to_string(conn->fd));
+	kill(cgi->getPid(), SIGKILL);
 	cgi->cleanup();
 	delete cgi;
 }
 
 void WebServer::handleCGIOutput(int fd) {
 	bool chunked = false;
-	CGI *cgi;
-	Connection *conn;
-	for (std::map<int, std::pair<CGI *, Connection *> >::iterator it = _cgi_pool.begin();
-	     it != _cgi_pool.end(); ++it) {
-		if (fd == it->first) {
-			cgi = it->second.first;
-			conn = it->second.second;
-		}
-	}
+	CGI *cgi = _fds[fd].cgi;
+	Connection *conn = _fds[fd].conn;
+
+	// The pipe is read to the end and closed by the handlers below
+	conn->cgi_fd = -1;
+	_fds.remove(fd);
+	epoll_ctl(_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
 	if (chunked)
 		chunkedResponse(cgi, conn);
 	else
 		normalResponse(cgi, conn);
-}
 
-bool WebServer::isCGIFd(int fd) const { return (_cgi_pool.find(fd) != _cgi_pool.end()); }
+	// The request is complete: go on with the ones pipelined behind it
+	conn->response_ready = false;
+	conn->state = Connection::READING_HEADERS;
+	if (!processReceivedData(conn)) {
+		conn->keep_persistent_connection = false;
+		closeConnection(conn);
+		return;
+	}
+	refreshTimeout(conn);
+}
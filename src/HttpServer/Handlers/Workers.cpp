@@ -0,0 +1,143 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Workers.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/18 10:12:40 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/18 10:12:40 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "src/HttpServer/Structs/WebServer.hpp"
+#include "src/HttpServer/Structs/Connection.hpp"
+#include "src/HttpServer/Structs/Response.hpp"
+#include "src/HttpServer/HttpServer.hpp"
+
+void WebServer::runMaster() {
+	int workers = _global.getWorkerProcesses();
+	_worker_started.assign(workers, 0);
+
+	_lggr.info("Master process " + su::to_string(getpid()) + " starting " +
+	           su::to_string(workers) + " workers");
+
+	for (int slot = 0; slot < workers; ++slot) {
+		if (!spawnWorker(slot)) {
+			stopWorkers();
+			return;
+		}
+	}
+
+	while (_running) {
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+
+		if (pid == -1) {
+			if (errno == EINTR) {
+				if (_stats_seen != _stats_requested)
+					forwardStatsRequest();
+				continue;
+			}
+			_lggr.error("waitpid failed: " + std::string(strerror(errno)));
+			break;
+		}
+
+		std::map<pid_t, int>::iterator it = _worker_pids.find(pid);
+		if (it == _worker_pids.end())
+			continue;
+		int slot = it->second;
+		_worker_pids.erase(it);
+
+		if (WIFEXITED(status) && WEXITSTATUS(status) == WORKER_INIT_FAILURE) {
+			_lggr.error("Worker " + su::to_string(slot) + " failed to initialize, shutting down");
+			break;
+		}
+		if (!_running)
+			break;
+
+		_lggr.warn("Worker " + su::to_string(slot) + " (pid " + su::to_string(pid) + ") " +
+		           (WIFSIGNALED(status) ? "killed by signal " + su::to_string(WTERMSIG(status))
+		                                : "exited with status " +
+		                                      su::to_string(WEXITSTATUS(status))) +
+		           ", respawning");
+
+		// Do not fork in a tight loop if a worker keeps crashing right away
+		if (getCurrentTime() - _worker_started[slot] < RESPAWN_DELAY)
+			sleep(RESPAWN_DELAY);
+		if (_running && !spawnWorker(slot))
+			break;
+	}
+
+	stopWorkers();
+	_lggr.info("Master process exiting");
+}
+
+bool WebServer::spawnWorker(int slot) {
+	pid_t pid = fork();
+
+	if (pid == -1) {
+		_lggr.error("Failed to fork worker " + su::to_string(slot) + ": " +
+		            std::string(strerror(errno)));
+		return false;
+	}
+	if (pid == 0) {
+		runWorker(slot);
+	}
+
+	_worker_pids[pid] = slot;
+	_worker_started[slot] = getCurrentTime();
+	_lggr.debug("Worker " + su::to_string(slot) + " started with pid " + su::to_string(pid));
+	return true;
+}
+
+void WebServer::runWorker(int slot) {
+	_worker_id = slot;
+	_worker_pids.clear();
+
+	if (!createEpollInstance()) {
+		std::exit(WORKER_INIT_FAILURE);
+	}
+	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
+		if (!initializeSingleServer(*it)) {
+			cleanup();
+			std::exit(WORKER_INIT_FAILURE);
+		}
+	}
+	if (!openReserveFd()) {
+		cleanup();
+		std::exit(WORKER_INIT_FAILURE);
+	}
+	_accept_stats.since = getCurrentTime();
+
+	if (!startEventLoops()) {
+		cleanup();
+		std::exit(WORKER_INIT_FAILURE);
+	}
+
+	_lggr.info("Worker " + su::to_string(slot) + " (pid " + su::to_string(getpid()) +
+	           ") accepting connections");
+	runEventLoop();
+	_running = false;
+	stopEventLoops();
+	cleanup();
+	std::exit(EXIT_SUCCESS);
+}
+
+void WebServer::forwardStatsRequest() {
+	_stats_seen = _stats_requested;
+	for (std::map<pid_t, int>::iterator it = _worker_pids.begin(); it != _worker_pids.end(); ++it) {
+		kill(it->first, SIGUSR1);
+	}
+}
+
+void WebServer::stopWorkers() {
+	for (std::map<pid_t, int>::iterator it = _worker_pids.begin(); it != _worker_pids.end(); ++it) {
+		kill(it->first, SIGTERM);
+	}
+	for (std::map<pid_t, int>::iterator it = _worker_pids.begin(); it != _worker_pids.end(); ++it) {
+		while (waitpid(it->first, NULL, 0) == -1 && errno == EINTR)
+			;
+	}
+	_worker_pids.clear();
+}
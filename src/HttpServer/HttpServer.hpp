@@ -26,6 +26,7 @@
 #define KEEP_ALIVE_TO 5 // seconds
 #define MAX_KEEP_ALIVE_REQS 100
 #define MAX_EVENTS 4096
+#define GZIP_MAX_SIZE (1024 * 1024) // larger files are not compressed on the fly
 
 #ifndef uint16_t
 #define uint16_t unsigned short
@@ -37,6 +37,13 @@ std::string WebServer::getFileContent(std::string path) {
 }
 
 FileType WebServer::checkFileType(const std::string &path) {
+	// A cached path needs no stat(), nor does one known to be missing; other
+	// misses fall through for the exact error
+	if (const CachedFile *file = _files.lookup(path))
+		return file->is_dir ? ISDIR : ISREG;
+	if (_files.enabled() && (errno == ENOENT || errno == ENOTDIR))
+		return NOT_FOUND_404;
+
 	struct stat pathStat;
 	if (stat(path.c_str(), &pathStat) != 0) {
 		if (errno == ENOTDIR || errno == ENOENT) {
@@ -54,7 +61,7 @@ FileType WebServer::checkFileType(const std::string &path) {
 	return FILE_SYSTEM_ERROR_500;
 }
 
-std::string WebServer::buildFullPath(const std::string &uri, LocConfig *location) {
+std::string WebServer::buildFullPath(const std::string &uri, const LocConfig *location) {
 	std::string prefix = (su::back(_root_prefix_path) == '/')
 	                         ? _root_prefix_path.substr(0, _root_prefix_path.length() - 1)
 	                         : _root_prefix_path;
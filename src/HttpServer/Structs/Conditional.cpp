@@ -0,0 +1,119 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Conditional.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/29 09:41:17 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/29 09:41:17 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "Conditional.hpp"
+#include "src/Utils/GeneralUtils.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+namespace Conditional {
+
+static inline std::string opaqueTag(const std::string &etag) {
+	return isWeak(etag) ? etag.substr(2) : etag;
+}
+
+bool matchesAny(const std::string &list, const std::string &etag) {
+	std::string tag = opaqueTag(etag);
+	size_t i = 0;
+	while (i < list.size()) {
+		while (i < list.size() && (list[i] == ' ' || list[i] == '\t' || list[i] == ','))
+			++i;
+		if (i >= list.size())
+			break;
+		if (list[i] == '*')
+			return true;
+		if (list.compare(i, 2, "W/") == 0)
+			i += 2;
+		if (i >= list.size() || list[i] != '"')
+			return false;
+		size_t end = list.find('"', i + 1);
+		if (end == std::string::npos)
+			return false;
+		if (list.compare(i, end + 1 - i, tag) == 0)
+			return true;
+		i = end + 1;
+	}
+	return false;
+}
+
+bool ifRangeMatches(const std::string &if_range, const std::string &etag, time_t mtime) {
+	if (isWeak(etag))
+		return false;
+	if (!if_range.empty() && (if_range[0] == '"' || isWeak(if_range)))
+		return if_range == etag;
+	return parseHttpDate(if_range) == mtime;
+}
+
+static bool parseOffset(const std::string &s, size_t begin, size_t end, off_t &value) {
+	if (begin >= end)
+		return false;
+	value = 0;
+	for (size_t i = begin; i < end; ++i) {
+		if (!std::isdigit(static_cast<unsigned char>(s[i])))
+			return false;
+		int digit = s[i] - '0';
+		if (value > (LLONG_MAX - digit) / 10)
+			return false;
+		value = value * 10 + digit;
+	}
+	return true;
+}
+
+bool parseRanges(const std::string &value, off_t size, std::vector<ByteRange> &ranges) {
+	if (value.size() < 6 || su::to_lower(value.substr(0, 6)) != "bytes=")
+		return false;
+	size_t i = 6;
+	size_t specs = 0;
+	while (i <= value.size()) {
+		size_t end = value.find(',', i);
+		if (end == std::string::npos)
+			end = value.size();
+		size_t begin = i;
+		i = end + 1;
+		while (begin < end && (value[begin] == ' ' || value[begin] == '\t'))
+			++begin;
+		while (end > begin && (value[end - 1] == ' ' || value[end - 1] == '\t'))
+			--end;
+		if (begin == end)
+			continue; // empty list elements are allowed
+		if (++specs > MAX_RANGES)
+			return false;
+		size_t dash = value.find('-', begin);
+		if (dash == std::string::npos || dash >= end)
+			return false;
+
+		ByteRange range;
+		if (dash == begin) {
+			// Suffix range: the last n bytes
+			off_t suffix;
+			if (!parseOffset(value, dash + 1, end, suffix))
+				return false;
+			if (suffix == 0 || size == 0)
+				continue;
+			range.first = suffix < size ? size - suffix : 0;
+			range.last = size - 1;
+		} else {
+			if (!parseOffset(value, begin, dash, range.first))
+				return false;
+			if (dash + 1 == end)
+				range.last = size - 1;
+			else if (!parseOffset(value, dash + 1, end, range.last) || range.last < range.first)
+				return false;
+			if (range.first >= size)
+				continue;
+			if (range.last >= size)
+				range.last = size - 1;
+		}
+		ranges.push_back(range);
+	}
+	return specs > 0;
+}
+} // namespace Conditional
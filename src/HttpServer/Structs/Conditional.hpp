@@ -0,0 +1,56 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Conditional.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/29 09:41:17 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/29 09:41:17 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONDITIONAL_HPP
+#define CONDITIONAL_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Parsing of the validator and range request headers (If-None-Match,
+/// If-Range, Range), apart from the server so that they can be tested alone.
+namespace Conditional {
+
+/// A request asking for more ranges than this gets the whole file instead.
+const size_t MAX_RANGES = 16;
+
+/// Inclusive byte offsets in the file.
+struct ByteRange {
+	off_t first;
+	off_t last;
+};
+
+inline bool isWeak(const std::string &etag) { return etag.compare(0, 2, "W/") == 0; }
+
+/// Weak comparison of an entity-tag against an If-None-Match list, or "*".
+/// \returns true if one of the tags matches.
+bool matchesAny(const std::string &list, const std::string &etag);
+
+/// Whether a Range may be honoured under If-Range. Only strong validators
+/// count: an entity-tag must be identical, a date must be the exact mtime.
+/// \param if_range Value of the If-Range header.
+/// \param etag Current entity-tag of the file.
+/// \param mtime Current modification time of the file.
+/// \returns false if the whole file must be sent.
+bool ifRangeMatches(const std::string &if_range, const std::string &etag, time_t mtime);
+
+/// Parses "bytes=a-b, c-, -n" into the ranges that overlap a file, clamped
+/// to it. Empty list elements are skipped.
+/// \param value Value of the Range header.
+/// \param size Size of the file.
+/// \param ranges Filled with the satisfiable ranges, in request order; empty
+///               if none is (416).
+/// \returns false if the header is not a valid byte range set or has more than
+///          MAX_RANGES elements, in which case it is ignored.
+bool parseRanges(const std::string &value, off_t size, std::vector<ByteRange> &ranges);
+} // namespace Conditional
+
+#endif
@@ -14,26 +14,56 @@
 #include "src/HttpServer/Structs/WebServer.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 
-Connection::Connection(int socket_fd)
-    : fd(socket_fd),
-      keep_persistent_connection(true),
-      body_bytes_read(0),
-      content_length(-1),
-      chunked(false),
-      chunk_size(0),
-      chunk_bytes_read(0),
-      response_ready(false),
-      request_count(0),
-      state(READING_HEADERS) {
+Connection::Connection() {
+	timer.data = this;
+	reset(-1);
+}
+
+void Connection::reset(int socket_fd) {
+	fd = socket_fd;
+	servConfig = NULL;
+	ctx.clear();
+	cgi_fd = -1;
+	cgi_deadline = 0;
+	keep_persistent_connection = true;
+	timeout_kind = NO_TIMEOUT;
+	read_buffer.clear();
+	resetForNewRequest();
+	output.clear();
+	epoll_events = EPOLLIN; // what registerClient() adds the socket with
+	request_count = 0;
+	state = READING_HEADERS;
 	updateActivity();
 }
 
-void Connection::updateActivity() { last_activity = time(NULL); }
+void Connection::resetForNewRequest() {
+	head.reset();
+	header_length = 0;
+	body_bytes_read = 0;
+	content_length = -1;
+	body.clear();
+	chunked = false;
+	chunk_size = 0;
+	chunk_bytes_read = 0;
+	chunk_line_scanned = 0;
+	trailer_length = 0;
+	response_ready = false;
+}
 
-bool Connection::isExpired(time_t current_time, int timeout) const {
-	return (current_time - last_activity) > timeout;
+// clear() keeps the capacity; swapping with an empty object is the C++98 way to release it
+void Connection::trimBuffers(size_t limit) {
+	if (read_buffer.capacity() > limit)
+		read_buffer.release();
+	if (body.capacity() > limit)
+		body.release();
 }
 
+size_t Connection::bufferCapacity() const {
+	return read_buffer.capacity() + body.capacity() + ctx.full_path.capacity();
+}
+
+void Connection::updateActivity() { last_activity = time(NULL); }
+
 void Connection::resetChunkedState() {
 	state = READING_HEADERS;
 	chunked = false;
@@ -53,8 +83,6 @@ std::string Connection::stateToString(Connection::State state) {
 		return "CONTINUE_SENT";
 	case Connection::READING_TRAILER:
 		return "READING_FINAL_TRAILER";
-	case Connection::CHUNK_COMPLETE:
-		return "CHUNK_COMPLETE";
 	case Connection::REQUEST_COMPLETE:
 		return "REQUEST_COMPLETE";
 	default:
@@ -79,12 +107,9 @@ std::string Connection::toString() {
 	time_buf[24] = '\0';
 
 	oss << "last_activity: " << time_buf << ", ";
-	oss << "read_buffer: \"" << read_buffer << "\", ";
+	oss << "read_buffer: \"" << read_buffer.substr(0) << "\", ";
 	oss << "response_ready: " << (response_ready ? "true" : "false") << ", ";
-	oss << "response_status: "
-	    << (response_ready ? su::to_string(response.status_code) + " " + response.reason_phrase
-	                       : "not ready")
-	    << ", ";
+	oss << "queued_output: " << output.size() << " bytes, ";
 	oss << "chunked: " << (chunked ? "true" : "false") << ", ";
 	oss << "keep_presistent_connection: " << (keep_persistent_connection ? "true" : "false")
 	    << ", ";
@@ -15,11 +15,38 @@
 
 #include "includes/Webserv.hpp"
 #include "src/ConfigParser/ConfigParser.hpp"
+#include "src/HttpServer/HttpServer.hpp"
 #include "Response.hpp"
+#include "TimerWheel.hpp"
+#include "IOBuffer.hpp"
+#include "RequestBody.hpp"
+#include "OutputQueue.hpp"
 
 class WebServer;
 class Response;
 
+/// What routing resolved for the request being processed, filled by
+/// WebServer::setupRequestContext(). The configuration it points into is
+/// shared read-only by all event loops; everything per request lives here.
+struct RequestContext {
+	const LocConfig *location; ///< Matched location block
+	bool exact;                ///< The location path is the whole request URI
+	std::string full_path;     ///< Resolved filesystem path
+	FileType file_type;        ///< What full_path is, see WebServer::checkFileType()
+
+	RequestContext()
+	    : location(NULL),
+	      exact(false),
+	      file_type(NOT_FOUND_404) {}
+
+	void clear() {
+		location = NULL;
+		exact = false;
+		full_path.clear();
+		file_type = NOT_FOUND_404;
+	}
+};
+
 /// Represents a client connection to the web server.
 ///
 /// This class manages the state of individual client connections including
@@ -32,29 +59,47 @@ class Response;
 /// keep-alive functionality.
 class Connection {
 	friend class WebServer;
+	friend class ConnectionPool;
 
 	int fd;
 
-	ServerConfig *servConfig;
-	LocConfig *locConfig;
+	const ServerConfig *servConfig;
+	RequestContext ctx;    // routing of the current request
+	int cgi_fd;            // output pipe of the CGI running for this connection, -1 if none
+	uint64_t cgi_deadline; // monotonic ms by which that CGI must have answered
 
 	time_t last_activity;
 	bool keep_persistent_connection;
 
-	std::string read_buffer;
+	/// Which timeout the connection timer currently measures.
+	enum TimeoutKind {
+		NO_TIMEOUT,        ///< Timer not armed
+		HEADER_TIMEOUT,    ///< Reading the request line and headers
+		BODY_TIMEOUT,      ///< Reading the body, re-armed on every read
+		KEEPALIVE_TIMEOUT, ///< Idle between two requests
+		SEND_TIMEOUT,      ///< Writing the response, re-armed on every write
+		CGI_TIMEOUT        ///< Waiting for the output of a CGI, counted from its fork
+	};
+
+	TimerWheel::Node timer;
+	TimeoutKind timeout_kind;
+
+	IOBuffer read_buffer;   // received bytes not consumed yet
+	HeadParser head;        // request line and headers, as offsets into read_buffer
+	size_t header_length;   // bytes of read_buffer taken by the headers, 0 until complete
 	size_t body_bytes_read; // for client_max_body_size
 	ssize_t content_length; // ignore if -1
-
-	std::vector<unsigned char> body_data;
+	RequestBody body;       // moved out of read_buffer (and decoded) as it arrives
 
 	bool chunked;
 	size_t chunk_size;
 	size_t chunk_bytes_read;
-	std::string chunk_data;
-	std::string headers_buffer;
+	size_t chunk_line_scanned; // bytes of the current size or trailer line searched for CRLF
+	size_t trailer_length;     // bytes of the trailer section received, MAX_HEAD_LENGTH at most
 
-	Response response;
-	bool response_ready;
+	bool response_ready;   // the final response of the current request is queued
+	OutputQueue output;    // responses not written yet, in request order
+	uint32_t epoll_events; // EPOLLIN or EPOLLOUT, as registered with epoll
 	int request_count;
 
 	/// Represents the current state of request processing.
@@ -67,25 +112,30 @@ class Connection {
 		READING_CHUNK_SIZE,    ///< Reading chunk size line
 		READING_CHUNK_DATA,    ///< Reading chunk data
 		READING_CHUNK_TRAILER, ///< Reading chunk trailer
-		READING_TRAILER,       ///< Reading final trailer
-		CHUNK_COMPLETE         ///< Chunked transfer complete
+		READING_TRAILER        ///< Reading final trailer
 	};
 
 	State state;
 
-	/// Constructs a new Connection object.
+	/// Constructs an unused Connection. Connections are handed out by the
+	/// ConnectionPool, which calls reset() for every new client.
+	Connection();
+
+	/// Prepares the object for a new client: every field goes back to its
+	/// initial value, the buffers keep their capacity.
 	/// \param socket_fd The file descriptor for the client socket.
-	Connection(int socket_fd);
+	void reset(int socket_fd);
+
+	/// Frees the buffers whose capacity grew above the limit.
+	/// \param limit Capacity (in bytes) a buffer may keep.
+	void trimBuffers(size_t limit);
+
+	/// \returns Bytes allocated by the buffers of the connection.
+	size_t bufferCapacity() const;
 
 	/// Updates the last activity timestamp to the current time.
 	void updateActivity();
 
-	/// Checks if the connection has expired based on timeout.
-	/// \param current_time The current timestamp.
-	/// \param timeout The timeout value in seconds.
-	/// \returns True if the connection has expired, false otherwise.
-	bool isExpired(time_t current_time, int timeout) const;
-
 	/// Resets the chunked transfer state to initial values.
 	void resetChunkedState();
 
@@ -98,10 +148,16 @@ class Connection {
 	/// \returns The string representation of the state.
 	std::string stateToString(Connection::State state);
 
-	void resetForNewRequest(); // reset locConfig body_bytes_read, ...
+	/// Forgets the request that was just processed (header and body
+	/// bookkeeping, chunk state, parser input).
+	void resetForNewRequest();
+
+	/// Checks if part of a response still has to be written.
+	/// \returns True if the output queue holds unsent bytes.
+	bool hasPendingOutput() const { return !output.empty(); }
 
   public:
-	ServerConfig *getServerConfig() const { return servConfig; }
+	const ServerConfig *getServerConfig() const { return servConfig; }
 };
 
 #endif
@@ -0,0 +1,78 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionPool.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/22 10:12:47 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/22 10:12:47 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ConnectionPool.hpp"
+
+ConnectionPool::ConnectionPool()
+    : _fresh(0),
+      _acquired(0),
+      _reused(0) {}
+
+ConnectionPool::~ConnectionPool() {
+	for (size_t i = 0; i < _slabs.size(); ++i) {
+		delete[] _slabs[i];
+	}
+}
+
+void ConnectionPool::grow() {
+	Connection *slab = new Connection[SLAB_SIZE];
+	_slabs.push_back(slab);
+	_free.reserve(_slabs.size() * SLAB_SIZE);
+	// Pushed in reverse so the slab is handed out in address order
+	for (size_t i = SLAB_SIZE; i > 0; --i) {
+		_free.push_back(&slab[i - 1]);
+	}
+	_fresh = SLAB_SIZE;
+}
+
+Connection *ConnectionPool::acquire(int fd) {
+	if (_free.empty())
+		grow();
+
+	// Never-used objects sit at the bottom of the free list, below the released ones
+	if (_free.size() > _fresh)
+		++_reused;
+	else
+		--_fresh;
+
+	Connection *conn = _free.back();
+	_free.pop_back();
+	++_acquired;
+	conn->reset(fd);
+	return conn;
+}
+
+void ConnectionPool::release(Connection *conn) {
+	if (!conn)
+		return;
+	conn->output.clear(); // closes the files still queued
+	conn->body.clear();   // and the temporary file of the last request body
+	conn->trimBuffers(RETAIN_LIMIT);
+	conn->fd = -1;
+	_free.push_back(conn);
+}
+
+ConnectionPool::Stats ConnectionPool::stats() const {
+	Stats stats;
+
+	stats.acquired = _acquired;
+	stats.reused = _reused;
+	stats.capacity = _slabs.size() * SLAB_SIZE;
+	stats.in_use = stats.capacity - _free.size();
+	stats.resident_bytes = stats.capacity * sizeof(Connection);
+	for (size_t i = 0; i < _slabs.size(); ++i) {
+		for (size_t j = 0; j < SLAB_SIZE; ++j) {
+			stats.resident_bytes += _slabs[i][j].bufferCapacity();
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,68 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionPool.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/22 10:12:47 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/22 10:12:47 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONNECTIONPOOL_HPP
+#define CONNECTIONPOOL_HPP
+
+#include "includes/Webserv.hpp"
+#include "Connection.hpp"
+
+/// Recycles Connection objects.
+///
+/// Connections are allocated in slabs of SLAB_SIZE and never freed before the
+/// pool is destroyed. A closed connection goes back on a free list with its
+/// buffers cleared but not released, so a short-lived client usually costs no
+/// allocation at all; buffers that grew above RETAIN_LIMIT (a large upload,
+/// a big chunked body) are released to keep the resident size bounded.
+class ConnectionPool {
+  public:
+	/// Counters, see stats().
+	struct Stats {
+		unsigned long acquired;  ///< Connections handed out
+		unsigned long reused;    ///< ... of which came from the free list
+		size_t in_use;           ///< Connections currently handed out
+		size_t capacity;         ///< Connection objects allocated
+		size_t resident_bytes;   ///< Objects plus the buffers they hold
+	};
+
+	ConnectionPool();
+	~ConnectionPool();
+
+	/// Hands out a connection, reset for the given socket.
+	/// \param fd The client socket.
+	/// \returns A connection, never NULL (allocation failures throw).
+	Connection *acquire(int fd);
+
+	/// Takes a connection back. It must not be used by the caller anymore.
+	/// \param conn A connection returned by acquire().
+	void release(Connection *conn);
+
+	/// Computes the counters. Walks every slab, meant for occasional logging.
+	Stats stats() const;
+
+	static const size_t SLAB_SIZE = 64;
+	static const size_t RETAIN_LIMIT = 64 * 1024; // per buffer
+
+  private:
+	std::vector<Connection *> _slabs; // arrays of SLAB_SIZE connections
+	std::vector<Connection *> _free;  // LIFO: the most recently used objects are still warm
+	size_t _fresh;                    // objects of _free that were never handed out
+	unsigned long _acquired;
+	unsigned long _reused;
+
+	ConnectionPool(const ConnectionPool &);
+	ConnectionPool &operator=(const ConnectionPool &);
+
+	void grow();
+};
+
+#endif
@@ -0,0 +1,68 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FdTable.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/20 10:02:31 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/20 10:02:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "FdTable.hpp"
+
+FdTable::FdTable()
+    : _clients(0) {
+	Slot empty = {EMPTY, NULL, NULL, NULL};
+	_empty = empty;
+	_slots.resize(INITIAL_SIZE, empty);
+}
+
+FdTable::Slot &FdTable::slotFor(int fd) {
+	size_t index = static_cast<size_t>(fd);
+	if (index >= _slots.size()) {
+		size_t size = _slots.size();
+		while (size <= index)
+			size *= 2;
+		_slots.resize(size, _empty);
+	}
+	Slot &slot = _slots[index];
+	if (slot.kind == CLIENT)
+		--_clients;
+	slot = _empty;
+	return slot;
+}
+
+void FdTable::addListener(int fd, const ServerConfig *server) {
+	Slot &slot = slotFor(fd);
+	slot.kind = LISTENER;
+	slot.server = server;
+}
+
+void FdTable::addClient(int fd, Connection *conn) {
+	Slot &slot = slotFor(fd);
+	slot.kind = CLIENT;
+	slot.conn = conn;
+	++_clients;
+}
+
+void FdTable::addCGI(int fd, CGI *cgi, Connection *conn) {
+	Slot &slot = slotFor(fd);
+	slot.kind = CGI_OUTPUT;
+	slot.cgi = cgi;
+	slot.conn = conn;
+}
+
+void FdTable::addWakeup(int fd) {
+	Slot &slot = slotFor(fd);
+	slot.kind = WAKEUP;
+}
+
+void FdTable::remove(int fd) {
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+		return;
+	if (_slots[fd].kind == CLIENT)
+		--_clients;
+	_slots[fd] = _empty;
+}
@@ -0,0 +1,86 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FdTable.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/20 10:02:31 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/20 10:02:31 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FDTABLE_HPP
+#define FDTABLE_HPP
+
+#include "includes/Webserv.hpp"
+
+class ServerConfig;
+class Connection;
+class CGI;
+
+/// Dense table indexed by file descriptor.
+///
+/// The kernel hands out the lowest free descriptor, so a vector indexed by fd
+/// stays compact and resolves what an epoll event belongs to (listener, client,
+/// CGI pipe, ...) with a single load instead of a scan plus map lookups.
+class FdTable {
+  public:
+	/// What a descriptor is used for.
+	enum Kind {
+		EMPTY = 0,  ///< Not tracked
+		LISTENER,   ///< Listening socket of a server block
+		CLIENT,     ///< Accepted client connection
+		CGI_OUTPUT, ///< Read end of a CGI stdout pipe
+		WAKEUP      ///< eventfd used to wake an event loop
+	};
+
+	struct Slot {
+		Kind kind;
+		const ServerConfig *server; ///< LISTENER
+		Connection *conn;     ///< CLIENT, and the client waiting for a CGI_OUTPUT
+		CGI *cgi;             ///< CGI_OUTPUT
+	};
+
+	FdTable();
+
+	/// Returns the slot of a descriptor, an EMPTY one if it is not tracked.
+	/// \param fd The file descriptor to look up.
+	inline const Slot &operator[](int fd) const {
+		return (fd >= 0 && static_cast<size_t>(fd) < _slots.size()) ? _slots[fd] : _empty;
+	}
+
+	/// Returns the connection of a CLIENT descriptor.
+	/// \param fd The file descriptor to look up.
+	/// \returns The connection, or NULL if fd is not a client socket.
+	inline Connection *connection(int fd) const {
+		const Slot &slot = (*this)[fd];
+		return slot.kind == CLIENT ? slot.conn : NULL;
+	}
+
+	void addListener(int fd, const ServerConfig *server);
+	void addClient(int fd, Connection *conn);
+	void addCGI(int fd, CGI *cgi, Connection *conn);
+	void addWakeup(int fd);
+
+	/// Forgets a descriptor. Does not close it.
+	/// \param fd The file descriptor to forget.
+	void remove(int fd);
+
+	/// \returns One past the highest descriptor the table has room for.
+	inline int size() const { return static_cast<int>(_slots.size()); }
+
+	/// \returns Number of CLIENT slots in use.
+	inline size_t clientCount() const { return _clients; }
+
+  private:
+	static const size_t INITIAL_SIZE = 1024;
+
+	std::vector<Slot> _slots;
+	size_t _clients;
+	Slot _empty;
+
+	Slot &slotFor(int fd);
+};
+
+#endif
@@ -0,0 +1,198 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FileCache.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/26 10:12:40 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/26 10:12:40 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "FileCache.hpp"
+#include "TimerWheel.hpp"
+#include "src/Utils/MimeTypes.hpp"
+
+CachedFile::CachedFile()
+    : is_dir(false),
+      fd(-1),
+      size(0),
+      mtime(0),
+      inode(0),
+      device(0),
+      compressible(false),
+      checked(0),
+      refs(1),
+      map(NULL),
+      error(0) {}
+
+CachedFile::~CachedFile() {
+	if (map)
+		munmap(map, static_cast<size_t>(size));
+	if (fd != -1)
+		close(fd);
+}
+
+const char *CachedFile::mapping() {
+	if (map || fd == -1 || size == 0)
+		return static_cast<const char *>(map);
+	void *addr = mmap(NULL, static_cast<size_t>(size), PROT_READ, MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED)
+		return NULL;
+	madvise(addr, static_cast<size_t>(size), MADV_SEQUENTIAL);
+	madvise(addr, static_cast<size_t>(size), MADV_WILLNEED);
+	map = addr;
+	return static_cast<const char *>(map);
+}
+
+void CachedFile::release() {
+	if (--refs == 0)
+		delete this;
+}
+
+FileCache::FileCache(size_t max_entries, uint64_t valid_ms)
+    : _max_entries(max_entries),
+      _valid_ms(valid_ms),
+      _hits(0),
+      _revalidations(0),
+      _misses(0),
+      _evictions(0) {}
+
+FileCache::~FileCache() { clear(); }
+
+CachedFile *FileCache::lookup(const std::string &path) {
+	if (_max_entries == 0)
+		return NULL;
+
+	uint64_t now = TimerWheel::now();
+	Index::iterator it = _index.find(path);
+	if (it != _index.end()) {
+		CachedFile *file = *it->second;
+		if (now - file->checked < _valid_ms) {
+			++_hits;
+			_lru.splice(_lru.begin(), _lru, it->second);
+			return found(file);
+		}
+
+		// Expired: one stat() tells whether the open file is still the right one
+		// (or whether a missing path is still missing). The requested path, not
+		// the resolved one: a symlink on the way may point elsewhere now.
+		++_revalidations;
+		struct stat st;
+		bool same;
+		if (file->error)
+			same = stat(path.c_str(), &st) == -1 && errno == file->error;
+		else
+			same = stat(path.c_str(), &st) == 0 && st.st_ino == file->inode &&
+			       st.st_dev == file->device && st.st_size == file->size &&
+			       st.st_mtime == file->mtime && S_ISDIR(st.st_mode) == file->is_dir;
+		if (same) {
+			file->checked = now;
+			_lru.splice(_lru.begin(), _lru, it->second);
+			return found(file);
+		}
+		remove(it);
+	} else
+		++_misses;
+	return load(path);
+}
+
+CachedFile *FileCache::load(const std::string &path) {
+	CachedFile *file = open(path);
+	if (!file) {
+		int error = errno;
+		if (error != ENOENT && error != ENOTDIR)
+			return NULL;
+		file = new CachedFile;
+		file->path = path;
+		file->resolved = path;
+		file->error = error;
+		file->checked = TimerWheel::now();
+	}
+	while (_lru.size() >= _max_entries) {
+		++_evictions;
+		remove(_index.find(_lru.back()->path));
+	}
+	_lru.push_front(file);
+	_index[path] = _lru.begin();
+	return found(file);
+}
+
+CachedFile *FileCache::found(CachedFile *file) {
+	if (file->error) {
+		errno = file->error;
+		return NULL;
+	}
+	return file;
+}
+
+CachedFile *FileCache::open(const std::string &path) const {
+	char resolved[PATH_MAX];
+	if (!realpath(path.c_str(), resolved))
+		return NULL;
+
+	struct stat st;
+	if (stat(resolved, &st) == -1)
+		return NULL;
+	if (!S_ISDIR(st.st_mode) && !S_ISREG(st.st_mode)) {
+		errno = EINVAL;
+		return NULL;
+	}
+
+	int fd = -1;
+	if (S_ISREG(st.st_mode)) {
+		fd = ::open(resolved, O_RDONLY | O_CLOEXEC);
+		if (fd == -1)
+			return NULL;
+	}
+
+	CachedFile *file = new CachedFile;
+	file->path = path;
+	file->resolved = resolved;
+	file->is_dir = S_ISDIR(st.st_mode);
+	file->fd = fd;
+	file->size = st.st_size;
+	file->mtime = st.st_mtime;
+	file->inode = st.st_ino;
+	file->device = st.st_dev;
+	file->checked = TimerWheel::now();
+	if (!file->is_dir) {
+		const MimeType &type = mimeType(path);
+		file->content_type = type.type;
+		file->compressible = type.compressible;
+		std::ostringstream etag;
+		etag << '"' << std::hex << static_cast<unsigned long>(st.st_ino) << '-'
+		     << static_cast<unsigned long>(st.st_size) << '-'
+		     << static_cast<unsigned long>(st.st_mtime) << '"';
+		file->etag = etag.str();
+	}
+	return file;
+}
+
+void FileCache::remove(Index::iterator it) {
+	CachedFile *file = *it->second;
+	_lru.erase(it->second);
+	_index.erase(it);
+	file->release();
+}
+
+void FileCache::clear() {
+	while (!_index.empty())
+		remove(_index.begin());
+}
+
+FileCache::Stats FileCache::stats() const {
+	Stats stats;
+	stats.hits = _hits;
+	stats.revalidations = _revalidations;
+	stats.misses = _misses;
+	stats.evictions = _evictions;
+	stats.entries = _lru.size();
+	stats.open_files = 0;
+	for (LruList::const_iterator it = _lru.begin(); it != _lru.end(); ++it) {
+		if ((*it)->fd != -1)
+			++stats.open_files;
+	}
+	return stats;
+}
@@ -0,0 +1,124 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   FileCache.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/26 10:12:40 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/26 10:12:40 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef FILECACHE_HPP
+#define FILECACHE_HPP
+
+#include "includes/Webserv.hpp"
+
+/// What the cache knows about a path, shared by the cache and the responses
+/// that are still sending the file. Reference counted: the descriptor is
+/// closed when the entry was evicted and the last send finished.
+struct CachedFile {
+	std::string path;         ///< Lookup key, as built from the request
+	std::string resolved;     ///< realpath() of path
+	bool is_dir;
+	int fd;                   ///< Open for reading, regular files only (-1 otherwise)
+	off_t size;
+	time_t mtime;
+	ino_t inode;
+	dev_t device;
+	std::string content_type; ///< Regular files only
+	bool compressible;        ///< Text-like content type, see mimeType()
+	std::string etag;         ///< Strong "inode-size-mtime" in hex, regular files only
+	uint64_t checked;         ///< Monotonic ms of the last stat()
+	size_t refs;              ///< 1 while cached, plus one per queued send
+	void *map;                ///< Read-only mapping of the whole file, see mapping()
+	int error;                ///< errno of a path that does not exist (ENOENT, ENOTDIR), else 0
+
+	CachedFile();
+	~CachedFile();
+
+	inline void retain() { ++refs; }
+
+	/// Maps the file on first use; every later request for it shares the
+	/// mapping. Hints the kernel to read ahead (sequential, willneed).
+	/// \returns The first byte of the file, or NULL if it cannot be mapped.
+	const char *mapping();
+
+	/// Drops a reference; the last one deletes the entry and closes the file.
+	void release();
+
+  private:
+	CachedFile(const CachedFile &);
+	CachedFile &operator=(const CachedFile &);
+};
+
+/// Bounded LRU cache of path -> (resolved path, type, open fd, size, mtime,
+/// inode, content type, ETag).
+///
+/// A hit younger than the validity period costs no system call. An older one
+/// is checked with a single stat(): if the inode, size and mtime did not
+/// change it is kept, otherwise it is dropped and loaded again. Paths that do
+/// not exist are cached too, so probing for optional files (precompressed
+/// siblings, index files) stays cheap. Each event loop owns its cache, so
+/// there is no locking.
+class FileCache {
+  public:
+	/// Counters, see stats().
+	struct Stats {
+		unsigned long hits;          ///< Lookups answered without a system call
+		unsigned long revalidations; ///< Lookups that needed a stat()
+		unsigned long misses;        ///< Lookups that loaded the path
+		unsigned long evictions;     ///< Entries dropped to stay within max_entries
+		size_t entries;
+		size_t open_files;
+	};
+
+	/// \param max_entries Maximum number of cached paths, 0 disables the cache.
+	/// \param valid_ms How long an entry is trusted without a stat().
+	FileCache(size_t max_entries, uint64_t valid_ms);
+	~FileCache();
+
+	/// Finds a path, loading or revalidating it as needed.
+	/// \param path Absolute path built from the request.
+	/// \returns The entry, valid until the next lookup or clear(); retain() it
+	///          to keep it longer. NULL when the cache is disabled or the path
+	///          is neither a readable regular file nor a directory (errno is set,
+	///          ENOENT or ENOTDIR for a missing path, cached or not).
+	CachedFile *lookup(const std::string &path);
+
+	/// Loads a path without caching it, for when the cache is disabled.
+	/// \param path Absolute path built from the request.
+	/// \returns A new entry owned by the caller (release() it), or NULL with
+	///          errno set, like lookup().
+	CachedFile *open(const std::string &path) const;
+
+	/// Drops every entry. Files still being sent stay open until they are done.
+	void clear();
+
+	inline bool enabled() const { return _max_entries > 0; }
+
+	Stats stats() const;
+
+  private:
+	typedef std::list<CachedFile *> LruList;
+	typedef std::map<std::string, LruList::iterator> Index;
+
+	size_t _max_entries;
+	uint64_t _valid_ms;
+	LruList _lru; // most recently used first
+	Index _index;
+	unsigned long _hits;
+	unsigned long _revalidations;
+	unsigned long _misses;
+	unsigned long _evictions;
+
+	FileCache(const FileCache &);
+	FileCache &operator=(const FileCache &);
+
+	CachedFile *load(const std::string &path);
+	CachedFile *found(CachedFile *file);
+	void remove(Index::iterator it);
+};
+
+#endif
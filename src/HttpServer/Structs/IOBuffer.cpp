@@ -0,0 +1,80 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IOBuffer.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/22 15:40:03 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/22 15:40:03 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "IOBuffer.hpp"
+
+IOBuffer::IOBuffer()
+    : _data(NULL),
+      _capacity(0),
+      _head(0),
+      _tail(0) {}
+
+IOBuffer::~IOBuffer() { delete[] _data; }
+
+char *IOBuffer::prepare(size_t n) {
+	if (_capacity - _tail >= n)
+		return _data + _tail;
+
+	size_t used = size();
+	if (used + n <= _capacity) {
+		// Enough room once the consumed bytes are reclaimed
+		std::memmove(_data, _data + _head, used);
+	} else {
+		size_t capacity = _capacity ? _capacity * 2 : MIN_CAPACITY;
+		while (capacity < used + n)
+			capacity *= 2;
+		char *data = new char[capacity];
+		if (used)
+			std::memcpy(data, _data + _head, used);
+		delete[] _data;
+		_data = data;
+		_capacity = capacity;
+	}
+	_head = 0;
+	_tail = used;
+	return _data + _tail;
+}
+
+void IOBuffer::append(const char *src, size_t n) {
+	std::memcpy(prepare(n), src, n);
+	commit(n);
+}
+
+void IOBuffer::erase(size_t pos, size_t n) {
+	size_t after = size() - pos - n;
+	if (after)
+		std::memmove(_data + _head + pos, _data + _head + pos + n, after);
+	_tail -= n;
+	if (_head == _tail)
+		_head = _tail = 0;
+}
+
+size_t IOBuffer::find(const char *needle, size_t from) const {
+	size_t len = std::strlen(needle);
+	if (from >= size() || size() - from < len)
+		return npos;
+	const void *match = memmem(data() + from, size() - from, needle, len);
+	return match ? static_cast<const char *>(match) - data() : npos;
+}
+
+std::string IOBuffer::substr(size_t pos, size_t len) const {
+	if (pos >= size())
+		return std::string();
+	return std::string(data() + pos, std::min(len, size() - pos));
+}
+
+void IOBuffer::release() {
+	delete[] _data;
+	_data = NULL;
+	_capacity = 0;
+	_head = _tail = 0;
+}
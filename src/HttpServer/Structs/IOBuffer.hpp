@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   IOBuffer.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/22 15:40:03 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/22 15:40:03 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef IOBUFFER_HPP
+#define IOBUFFER_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Growable input buffer with a read position (head) and a write position (tail).
+///
+/// recv() writes straight into the tail (prepare() + commit()) and parsers drop
+/// what they used from the head (consume()) in O(1), so neither side copies the
+/// rest of the data. The unread bytes are always contiguous, which lets the
+/// parsers search them directly; the space freed at the head is reclaimed by
+/// moving the unread bytes to the front, only when the tail runs out of room.
+class IOBuffer {
+  public:
+	static const size_t npos = static_cast<size_t>(-1);
+
+	IOBuffer();
+	~IOBuffer();
+
+	/// \returns The first unread byte.
+	inline const char *data() const { return _data + _head; }
+
+	/// \returns Number of unread bytes.
+	inline size_t size() const { return _tail - _head; }
+
+	inline bool empty() const { return _tail == _head; }
+
+	/// \returns Bytes allocated.
+	inline size_t capacity() const { return _capacity; }
+
+	/// Makes room for at least n bytes after the unread ones.
+	/// \param n Number of bytes about to be written.
+	/// \returns Where to write them; call commit() with the number actually written.
+	char *prepare(size_t n);
+
+	/// Adds the bytes written at the pointer returned by prepare().
+	/// \param n Number of bytes written.
+	inline void commit(size_t n) { _tail += n; }
+
+	/// Copies bytes at the end of the buffer.
+	/// \param src The bytes.
+	/// \param n Number of bytes.
+	void append(const char *src, size_t n);
+
+	/// Drops bytes from the front.
+	/// \param n Number of bytes, at most size().
+	inline void consume(size_t n) {
+		_head += n;
+		if (_head >= _tail)
+			_head = _tail = 0;
+	}
+
+	inline void clear() { _head = _tail = 0; }
+
+	/// Drops bytes from the middle, moving the ones after them down.
+	/// \param pos Offset from data() of the first byte dropped.
+	/// \param n Number of bytes, at most size() - pos.
+	void erase(size_t pos, size_t n);
+
+	/// Searches the unread bytes.
+	/// \param needle The string to look for.
+	/// \param from Offset (from data()) where the search starts.
+	/// \returns Offset of the first match from data(), or npos.
+	size_t find(const char *needle, size_t from = 0) const;
+
+	/// Copies part of the unread bytes.
+	/// \param pos Offset from data().
+	/// \param len Number of bytes, clamped to what is available.
+	std::string substr(size_t pos, size_t len = npos) const;
+
+	/// Frees the storage. The buffer must be empty or its content is lost.
+	void release();
+
+  private:
+	static const size_t MIN_CAPACITY = 4096;
+
+	char *_data;
+	size_t _capacity;
+	size_t _head; // first unread byte
+	size_t _tail; // one past the last unread byte
+
+	IOBuffer(const IOBuffer &);
+	IOBuffer &operator=(const IOBuffer &);
+};
+
+#endif
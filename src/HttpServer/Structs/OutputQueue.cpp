@@ -0,0 +1,196 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   OutputQueue.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/25 09:48:15 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/25 09:48:15 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "OutputQueue.hpp"
+#include "FileCache.hpp"
+
+const size_t OutputQueue::FILE_CHUNK; // bound to a reference by std::min
+
+OutputQueue::OutputQueue()
+    : _sent(0),
+      _bytes(0) {}
+
+OutputQueue::~OutputQueue() { clear(); }
+
+void OutputQueue::push(std::string &data) {
+	if (data.empty())
+		return;
+	_segments.push_back(Segment());
+	Segment &seg = _segments.back();
+	seg.data.swap(data);
+	seg.shared = NULL;
+	seg.fd = -1;
+	seg.offset = 0;
+	seg.length = 0;
+	seg.close_fd = false;
+	seg.file = NULL;
+	_bytes += seg.data.size();
+}
+
+void OutputQueue::append(const std::string &data) {
+	std::string copy(data);
+	push(copy);
+}
+
+void OutputQueue::push(SharedBuffer *buffer) {
+	if (buffer->data.empty())
+		return;
+	buffer->retain();
+	_segments.push_back(Segment());
+	Segment &seg = _segments.back();
+	seg.shared = buffer;
+	seg.fd = -1;
+	seg.offset = 0;
+	seg.length = 0;
+	seg.close_fd = false;
+	seg.file = NULL;
+	_bytes += buffer->data.size();
+}
+
+void OutputQueue::pushFile(int fd, off_t offset, size_t length, bool close_fd) {
+	if (length == 0) {
+		if (close_fd)
+			close(fd);
+		return;
+	}
+	_segments.push_back(Segment());
+	Segment &seg = _segments.back();
+	seg.shared = NULL;
+	seg.fd = fd;
+	seg.offset = offset;
+	seg.length = length;
+	seg.close_fd = close_fd;
+	seg.file = NULL;
+	_bytes += length;
+}
+
+void OutputQueue::pushFile(CachedFile *file, off_t offset, size_t length) {
+	if (length == 0)
+		return;
+	file->retain();
+	_segments.push_back(Segment());
+	Segment &seg = _segments.back();
+	seg.shared = NULL;
+	seg.fd = file->fd;
+	seg.offset = offset;
+	seg.length = length;
+	seg.close_fd = false;
+	seg.file = file;
+	_bytes += length;
+}
+
+void OutputQueue::pushMapped(CachedFile *file, off_t offset, size_t length) {
+	if (length == 0)
+		return;
+	file->retain();
+	_segments.push_back(Segment());
+	Segment &seg = _segments.back();
+	seg.shared = NULL;
+	seg.fd = -1;
+	seg.offset = offset;
+	seg.length = length;
+	seg.close_fd = false;
+	seg.file = file;
+	_bytes += length;
+}
+
+const char *OutputQueue::Segment::bytes() const {
+	if (file)
+		return static_cast<const char *>(file->map) + offset;
+	return shared ? shared->data.data() : data.data();
+}
+
+size_t OutputQueue::Segment::size() const {
+	if (file)
+		return length;
+	return shared ? shared->data.size() : data.size();
+}
+
+ssize_t OutputQueue::writeTo(int sock) {
+	if (_segments.empty())
+		return 0;
+	if (_segments.front().inMemory())
+		return writeMemory(sock);
+	return writeFile(sock);
+}
+
+ssize_t OutputQueue::writeMemory(int sock) {
+	struct iovec iov[MAX_IOV];
+	int count = 0;
+
+	for (std::deque<Segment>::const_iterator it = _segments.begin();
+	     it != _segments.end() && it->inMemory() && count < MAX_IOV; ++it, ++count) {
+		size_t skip = (count == 0) ? _sent : 0;
+		iov[count].iov_base = const_cast<char *>(it->bytes()) + skip;
+		iov[count].iov_len = it->size() - skip;
+	}
+
+	// sendmsg() is writev() with flags: MSG_NOSIGNAL, a reset peer must not raise SIGPIPE
+	struct msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = count;
+	ssize_t sent = sendmsg(sock, &msg, MSG_NOSIGNAL);
+	if (sent > 0)
+		consume(sent);
+	return sent;
+}
+
+ssize_t OutputQueue::writeFile(int sock) {
+	const Segment &seg = _segments.front();
+	size_t want = std::min(seg.length - _sent, FILE_CHUNK);
+
+	// The kernel copies from the page cache to the socket: no read() into user space
+	off_t offset = seg.offset + static_cast<off_t>(_sent);
+	ssize_t sent = sendfile(sock, seg.fd, &offset, want);
+	if (sent == 0) {
+		errno = EIO; // the file shrank after its size was announced
+		return -1;
+	}
+	if (sent > 0)
+		consume(sent);
+	return sent;
+}
+
+void OutputQueue::consume(size_t n) {
+	_bytes -= n;
+	while (!_segments.empty()) {
+		size_t left = _segments.front().size() - _sent;
+		if (n < left) {
+			_sent += n;
+			return;
+		}
+		n -= left;
+		popFront();
+	}
+}
+
+void OutputQueue::popFront() {
+	Segment &seg = _segments.front();
+	if (seg.fd != -1 && seg.close_fd)
+		close(seg.fd);
+	if (seg.file)
+		seg.file->release();
+	if (seg.shared)
+		seg.shared->release();
+	// Recycled for the next head, unless it is a large body
+	if (seg.data.capacity() > _spare.capacity() && seg.data.capacity() <= SPARE_MAX)
+		_spare.swap(seg.data);
+	_segments.pop_front();
+	_sent = 0;
+}
+
+void OutputQueue::clear() {
+	while (!_segments.empty())
+		popFront();
+	_bytes = 0;
+}
@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   OutputQueue.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/25 09:48:15 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/25 09:48:15 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef OUTPUTQUEUE_HPP
+#define OUTPUTQUEUE_HPP
+
+#include "includes/Webserv.hpp"
+
+struct CachedFile;
+
+/// A block of memory queued on several connections at once (a cached
+/// response). Reference counted: deleted when the last holder releases it.
+struct SharedBuffer {
+	std::string data;
+	size_t refs;
+
+	SharedBuffer()
+	    : refs(1) {}
+
+	inline void retain() { ++refs; }
+
+	inline void release() {
+		if (--refs == 0)
+			delete this;
+	}
+
+  private:
+	SharedBuffer(const SharedBuffer &);
+	SharedBuffer &operator=(const SharedBuffer &);
+};
+
+/// Bytes waiting to be written to a client socket, in order.
+///
+/// A segment is either a block of memory (response headers, a body) or a range
+/// of an open file. Consecutive memory segments are written with one gathering
+/// sendmsg(); a file range goes from the page cache to the socket with
+/// sendfile(), so its bytes never pass through user space. The queue remembers
+/// how much of its first segment was already written, so it can be drained over
+/// any number of EPOLLOUT events.
+class OutputQueue {
+  public:
+	OutputQueue();
+	~OutputQueue();
+
+	/// Queues a block of memory. The string is taken over (swapped), not copied.
+	/// \param data The bytes; left empty on return.
+	void push(std::string &data);
+
+	/// Queues a copy of a block of memory.
+	/// \param data The bytes.
+	void append(const std::string &data);
+
+	/// Queues a shared block of memory without copying it. The queue holds a
+	/// reference until the block is written.
+	/// \param buffer The block.
+	void push(SharedBuffer *buffer);
+
+	/// Queues a range of an open file.
+	/// \param fd The file, sent with sendfile() from an explicit offset, so its
+	///           own file offset does not matter.
+	/// \param offset First byte of the range.
+	/// \param length Number of bytes.
+	/// \param close_fd Whether the queue closes fd once the range is written.
+	void pushFile(int fd, off_t offset, size_t length, bool close_fd);
+
+	/// Queues a range of a file of the open-file cache. The queue holds a
+	/// reference until the range is written, so the descriptor stays open even
+	/// if the cache drops the entry meanwhile.
+	/// \param file The cached file.
+	/// \param offset First byte of the range.
+	/// \param length Number of bytes.
+	void pushFile(CachedFile *file, off_t offset, size_t length);
+
+	/// Queues a range of the mapping of a cached file (see CachedFile::mapping()).
+	/// It is written like memory, gathered with the segments around it.
+	/// \param file The cached file, already mapped.
+	/// \param offset First byte of the range.
+	/// \param length Number of bytes.
+	void pushMapped(CachedFile *file, off_t offset, size_t length);
+
+	/// Storage to serialize the next memory segment into before push(): empty,
+	/// but with the capacity of a segment already written, so that building the
+	/// head of a response allocates nothing once the connection has sent one.
+	/// \returns The buffer, owned by the queue.
+	inline std::string &scratch() {
+		_spare.clear();
+		return _spare;
+	}
+
+	inline bool empty() const { return _segments.empty(); }
+
+	/// \returns Number of bytes not written yet.
+	inline size_t size() const { return _bytes; }
+
+	/// Writes the front of the queue: every leading memory or mapped segment
+	/// (up to MAX_IOV) in one call, or the next piece of a file range.
+	/// \param sock The client socket.
+	/// \returns Bytes written, or -1 with errno set (EAGAIN when the socket is full).
+	ssize_t writeTo(int sock);
+
+	/// Drops everything and closes the files the queue owns.
+	void clear();
+
+	static const int MAX_IOV = 64;            // memory segments per sendmsg()
+	static const size_t FILE_CHUNK = 256 * 1024; // bytes of a file range per sendfile()
+	static const size_t SPARE_MAX = 4096;        // largest written segment kept for scratch()
+
+  private:
+	struct Segment {
+		std::string data;     // memory segment
+		SharedBuffer *shared; // memory segment held by reference, instead of data
+		int fd;               // file segment if != -1
+		off_t offset;
+		size_t length;
+		bool close_fd;
+		CachedFile *file;     // reference released once written; mapped segment if fd == -1
+
+		inline bool inMemory() const { return fd == -1; }
+		const char *bytes() const;
+		size_t size() const;
+	};
+
+	std::deque<Segment> _segments;
+	size_t _sent;  // bytes of the front segment already written
+	size_t _bytes; // bytes not written yet, over all segments
+	std::string _spare; // storage of a written segment, see scratch()
+
+	OutputQueue(const OutputQueue &);
+	OutputQueue &operator=(const OutputQueue &);
+
+	ssize_t writeMemory(int sock);
+	ssize_t writeFile(int sock);
+	void consume(size_t n);
+	void popFront();
+};
+
+#endif
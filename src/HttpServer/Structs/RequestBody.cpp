@@ -0,0 +1,86 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RequestBody.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/05 10:12:36 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/05 10:12:36 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "RequestBody.hpp"
+
+const size_t RequestBody::MAX_MEMORY_LIMIT;
+
+RequestBody::RequestBody()
+    : _fd(-1),
+      _size(0),
+      _memory_limit(MAX_MEMORY_LIMIT) {}
+
+RequestBody::~RequestBody() { clear(); }
+
+void RequestBody::setMemoryLimit(size_t limit) {
+	_memory_limit = std::min(limit, MAX_MEMORY_LIMIT);
+}
+
+bool RequestBody::append(const char *data, size_t n) {
+	if (_fd == -1 && _size + n > _memory_limit && !spill())
+		return false;
+	if (_fd == -1)
+		_memory.append(data, n);
+	else if (!writeFile(data, n))
+		return false;
+	_size += n;
+	return true;
+}
+
+int RequestBody::file() const {
+	if (_fd == -1 || lseek(_fd, 0, SEEK_SET) == -1)
+		return -1;
+	return _fd;
+}
+
+void RequestBody::clear() {
+	if (_fd != -1)
+		close(_fd);
+	_fd = -1;
+	_memory.clear();
+	_size = 0;
+}
+
+void RequestBody::release() { std::string().swap(_memory); }
+
+// Moves what is in memory to a new temporary file. The name is unlinked right
+// away: the file goes when the descriptor is closed, even if the process dies.
+bool RequestBody::spill() {
+	const char *dir = std::getenv("TMPDIR");
+	std::string path = std::string(dir && *dir ? dir : "/tmp") + "/webserv-body-XXXXXX";
+	_fd = mkstemp(&path[0]);
+	if (_fd == -1)
+		return false;
+	unlink(path.c_str());
+	// Only the CGI that reads the body gets it, as its stdin
+	fcntl(_fd, F_SETFD, FD_CLOEXEC);
+	if (!writeFile(_memory.data(), _memory.size())) {
+		close(_fd);
+		_fd = -1;
+		return false;
+	}
+	_memory.clear();
+	return true;
+}
+
+bool RequestBody::writeFile(const char *data, size_t n) {
+	while (n > 0) {
+		ssize_t written = write(_fd, data, n);
+		if (written == -1 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return false;
+		data += written;
+		n -= written;
+	}
+	return true;
+}
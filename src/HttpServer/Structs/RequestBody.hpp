@@ -0,0 +1,82 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RequestBody.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/05 10:12:36 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/05 10:12:36 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REQUEST_BODY_HPP
+#define REQUEST_BODY_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Body of the request being received, filled as the bytes arrive.
+///
+/// A small body stays in memory. Once it grows past the memory limit
+/// (client_body_buffer_size) it is moved to a temporary file, unlinked as soon
+/// as it is created, and every later byte is written there: an upload costs at
+/// most the limit in memory, whatever its size. A body in a file is handed to
+/// the CGI as its stdin, the script reads it from the disk.
+class RequestBody {
+  public:
+	/// Largest memory limit. A body in memory is written to the stdin pipe of
+	/// the CGI in one go: it must fit in the pipe buffer, 64K on Linux but only
+	/// one page once the user has used up its share of pipe memory. PIPE_BUF
+	/// bytes always fit.
+	static const size_t MAX_MEMORY_LIMIT = PIPE_BUF;
+
+	RequestBody();
+	~RequestBody();
+
+	/// Sets the size above which the body goes to a file, capped at
+	/// MAX_MEMORY_LIMIT. Applies from the next append().
+	void setMemoryLimit(size_t limit);
+
+	/// Adds received bytes at the end of the body.
+	/// \returns false if the temporary file could not be created or written
+	///          (errno is set); the body is incomplete.
+	bool append(const char *data, size_t n);
+
+	/// \returns Bytes received.
+	inline size_t size() const { return _size; }
+
+	inline bool empty() const { return _size == 0; }
+
+	/// \returns true if the body is in a temporary file rather than in memory.
+	inline bool inFile() const { return _fd != -1; }
+
+	/// \returns The body, when it is in memory.
+	inline const std::string &memory() const { return _memory; }
+
+	/// \returns The temporary file, positioned at the start of the body, or -1
+	///          if the body is in memory or the file cannot be rewound.
+	int file() const;
+
+	/// Forgets the body: closes the file, keeps the memory.
+	void clear();
+
+	/// \returns Bytes allocated in memory.
+	inline size_t capacity() const { return _memory.capacity(); }
+
+	/// Frees the memory. The body must be empty or in a file.
+	void release();
+
+  private:
+	std::string _memory;
+	int _fd; // temporary file, -1 while the body is in memory
+	size_t _size;
+	size_t _memory_limit;
+
+	bool spill();
+	bool writeFile(const char *data, size_t n);
+
+	RequestBody(const RequestBody &);
+	RequestBody &operator=(const RequestBody &);
+};
+
+#endif
@@ -2,97 +2,157 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/ConfigParser/ConfigParser.hpp"
 #include "src/HttpServer/HttpServer.hpp"
-
-// Local helpers for MIME detection to avoid depending on WebServer
-static std::string getExtensionForMime(const std::string &path) {
-	std::size_t dot_pos = path.find_last_of('.');
-	std::size_t qm_pos = path.find_first_of('?');
-	if (qm_pos != std::string::npos && dot_pos < qm_pos)
-		return path.substr(dot_pos, qm_pos - dot_pos);
-	else if (qm_pos == std::string::npos && dot_pos != std::string::npos)
-		return path.substr(dot_pos);
-	return "";
-}
-
-static std::string detectContentTypeLocal(const std::string &path) {
-	std::map<std::string, std::string> cTypes;
-	cTypes[".css"] = "text/css";
-	cTypes[".js"] = "application/javascript";
-	cTypes[".html"] = "text/html";
-	cTypes[".htm"] = "text/html";
-	cTypes[".json"] = "application/json";
-	cTypes[".png"] = "image/png";
-	cTypes[".jpg"] = "image/jpeg";
-	cTypes[".jpeg"] = "image/jpeg";
-	cTypes[".gif"] = "image/gif";
-	cTypes[".svg"] = "image/svg+xml";
-	cTypes[".ico"] = "image/x-icon";
-	cTypes[".txt"] = "text/plain";
-	cTypes[".pdf"] = "application/pdf";
-	cTypes[".zip"] = "application/zip";
-
-	std::string ext = getExtensionForMime(path);
-	std::map<std::string, std::string>::const_iterator it = cTypes.find(ext);
-	if (it != cTypes.end())
-		return it->second;
-	return "application/octet-stream";
-}
+#include "src/HttpServer/Structs/FileCache.hpp"
+#include "src/HttpServer/Structs/OutputQueue.hpp"
+#include "src/HttpServer/Structs/ResponseWriter.hpp"
+#include "src/Utils/MimeTypes.hpp"
 
 Logger Response::tmplogg_("Response", Logger::DEBUG);
 
 Response::Response()
     : version("HTTP/1.1"),
       status_code(0),
-      reason_phrase("Not Ready") {}
+      reason_phrase("Not Ready"),
+      body_file(NULL),
+      body_offset(0),
+      body_length(0),
+      body_mapped(false),
+      cached(NULL) {}
 
 Response::Response(uint16_t code)
     : version("HTTP/1.1"),
-      status_code(code) {
+      status_code(code),
+      body_file(NULL),
+      body_offset(0),
+      body_length(0),
+      body_mapped(false),
+      cached(NULL) {
 	initFromStatusCode(code);
 }
 
 Response::Response(uint16_t code, const std::string &response_body)
     : version("HTTP/1.1"),
       status_code(code),
-      body(response_body) {
+      body(response_body),
+      body_file(NULL),
+      body_offset(0),
+      body_length(0),
+      body_mapped(false),
+      cached(NULL) {
 	initFromStatusCode(code);
 }
 
 Response::Response(uint16_t code, Connection *conn)
     : version("HTTP/1.1"),
-      status_code(code) {
+      status_code(code),
+      body_file(NULL),
+      body_offset(0),
+      body_length(0),
+      body_mapped(false),
+      cached(NULL) {
 	initFromCustomErrorPage(code, conn);
 }
 
-std::string Response::toString() const {
-	std::ostringstream response_stream;
-	response_stream << version << " " << status_code << " " << reason_phrase << "\r\n";
-	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
-	     it != headers.end(); ++it) {
-		response_stream << it->first << ": " << it->second << "\r\n";
+Response::Response(const Response &other)
+    : version(other.version),
+      status_code(other.status_code),
+      reason_phrase(other.reason_phrase),
+      headers(other.headers),
+      body(other.body),
+      body_file(other.body_file),
+      body_offset(other.body_offset),
+      body_length(other.body_length),
+      body_mapped(other.body_mapped),
+      body_parts(other.body_parts),
+      cached(other.cached) {
+	if (body_file)
+		body_file->retain();
+	if (cached)
+		cached->retain();
+}
+
+Response &Response::operator=(const Response &other) {
+	if (this == &other)
+		return *this;
+	version = other.version;
+	status_code = other.status_code;
+	reason_phrase = other.reason_phrase;
+	headers = other.headers;
+	body = other.body;
+	if (other.body_file)
+		other.body_file->retain();
+	if (body_file)
+		body_file->release();
+	body_file = other.body_file;
+	body_offset = other.body_offset;
+	body_length = other.body_length;
+	body_mapped = other.body_mapped;
+	body_parts = other.body_parts;
+	setCachedResponse(other.cached);
+	return *this;
+}
+
+Response::~Response() {
+	setBodyFile(NULL, 0, 0);
+	setCachedResponse(NULL);
+}
+
+void Response::setHeader(const std::string &name, const std::string &value) {
+	for (HeaderList::iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (it->first == name) {
+			it->second = value;
+			return;
+		}
 	}
-	response_stream << "\r\n";
-	response_stream << body;
-	return response_stream.str();
+	headers.push_back(std::make_pair(name, value));
 }
 
-std::string Response::toStringHeadersOnly() const {
-	std::ostringstream response_stream;
-	response_stream << version << " " << status_code << " " << reason_phrase << "\r\n";
-	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
-	     it != headers.end(); ++it) {
-		response_stream << it->first << ": " << it->second << "\r\n";
+const std::string *Response::getHeader(const std::string &name) const {
+	for (HeaderList::const_iterator it = headers.begin(); it != headers.end(); ++it) {
+		if (it->first == name)
+			return &it->second;
 	}
-	response_stream << "\r\n";
-	return response_stream.str();
+	return NULL;
+}
+
+void Response::setContentLength(size_t length) {
+	setHeader("Content-Length", ResponseWriter::numberToString(length));
+}
+
+void Response::writeHead(std::string &out, const std::string &date) const {
+	if (version != "HTTP/1.1" || !ResponseWriter::appendStatusLine(out, status_code)) {
+		out += version + " " + ResponseWriter::numberToString(status_code) + " " + reason_phrase +
+		       "\r\n";
+	}
+	out += date;
+	writeHeaders(out);
+}
+
+void Response::writeHeaders(std::string &out) const {
+	for (HeaderList::const_iterator it = headers.begin(); it != headers.end(); ++it)
+		ResponseWriter::appendHeader(out, it->first, it->second);
+	out.append("\r\n", 2);
+}
+
+std::string Response::toString() const {
+	std::string out;
+	out.reserve(256 + body.size());
+	writeHead(out, "");
+	out += body;
+	return out;
+}
+
+std::string Response::toStringHeadersOnly() const {
+	std::string out;
+	writeHead(out, "");
+	return out;
 }
 
 std::string Response::toShortString() const {
 	std::ostringstream response_stream;
 	response_stream << version << " " << status_code << " " << reason_phrase;
-	if (headers.find("Content-Length") != headers.end()) {
-		response_stream << " Content-Len.: " << headers.find("Content-Length")->second;
-	}
+	if (const std::string *length = getHeader("Content-Length"))
+		response_stream << " Content-Len.: " << *length;
 	return response_stream.str();
 }
 
@@ -101,6 +161,30 @@ void Response::reset() {
 	reason_phrase = "Not ready";
 	headers.clear();
 	body.clear();
+	setBodyFile(NULL, 0, 0);
+	body_parts.clear();
+	setCachedResponse(NULL);
+}
+
+void Response::setBodyFile(CachedFile *file, off_t offset, size_t length, bool mapped) {
+	if (file)
+		file->retain();
+	if (body_file)
+		body_file->release();
+	body_file = file;
+	body_offset = offset;
+	body_length = length;
+	body_mapped = mapped;
+	if (file)
+		setContentLength(length);
+}
+
+void Response::setCachedResponse(SharedBuffer *response) {
+	if (response)
+		response->retain();
+	if (cached)
+		cached->release();
+	cached = response;
 }
 
 Response Response::continue_() { return Response(100); }
@@ -144,128 +228,68 @@ Response Response::internalServerError(Connection *conn) { return Response(500,
 Response Response::notImplemented(Connection *conn) { return Response(501, conn); }
 
 std::string Response::getReasonPhrase(uint16_t code) const {
-	switch (code) {
-	case 100:
-		return "Continue";
-	case 200:
-		return "OK";
-	case 201:
-		return "Created";
-	case 204:
-		return "No Content";
-	case 301:
-		return "Moved Permanently";
-	case 302:
-		return "Found";
-	case 304:
-		return "Not Modified";
-	case 400:
-		return "Bad Request";
-	case 401:
-		return "Unauthorized";
-	case 403:
-		return "Forbidden";
-	case 404:
-		return "Not Found";
-	case 405:
-		return "Method Not Allowed";
-	case 408:
-		return "Request Timeout";
-	case 413:
-		return "Content Too Large";
-	case 414:
-		return "URI Too Long";
-	case 500:
-		return "Internal Server Error";
-	case 501:
-		return "Not Implemented";
-	case 502:
-		return "Bad Gateway";
-	case 503:
-		return "Service Unavailable";
-	default:
-		return "Unknown Status";
-	}
+	const char *reason = ResponseWriter::reasonPhrase(code);
+	return reason ? reason : "Unknown Status";
 }
 
 void Response::initFromCustomErrorPage(uint16_t code, Connection *conn) {
-
 	reason_phrase = getReasonPhrase(code);
 
-	if (!conn || !conn->getServerConfig() || !conn->getServerConfig()->hasErrorPage(code)) {
-		tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-		                       "No custom error page for " + su::to_string(code));
-		tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-		                       "Creating the default error page for " + su::to_string(code));
-		initFromStatusCode(code);
-		return;
-	}
-	tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-	                       "A custom error page exists for " + su::to_string(code));
-	// todo check path again
-	std::string fullPath =
-	    conn->getServerConfig()->getPrefix() + conn->getServerConfig()->getErrorPage(code);
-	std::ifstream errorFile(fullPath.c_str());
-	if (!errorFile.is_open()) {
-		tmplogg_.logWithPrefix(Logger::WARNING, "Response",
-		                       "Custom error page " + fullPath + " could not be opened.");
+	// Custom and default pages were loaded with the configuration
+	const ServerConfig *sc = conn ? conn->getServerConfig() : NULL;
+	const ServerConfig::ErrorBody *page = sc ? sc->findErrorBody(code) : NULL;
+	if (!page) {
 		initFromStatusCode(code);
 		return;
 	}
-
-	std::ostringstream errorPage;
-	errorPage << errorFile.rdbuf();
-	body = errorPage.str();
+	body = page->body;
 	setContentLength(body.length());
-	setContentType(detectContentTypeLocal(fullPath));
-	errorFile.close();
-	tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-	                       "Custom error page " + su::to_string(code) + " has been loaded.");
+	setContentType(page->content_type);
 }
 
 void Response::initFromStatusCode(uint16_t code) {
 	reason_phrase = getReasonPhrase(code);
-	if (code >= 400) {
-		if (body.empty()) {
-			tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-			                       "No custom error page for " + su::to_string(code) +
-			                           " could be used or exist. Generating the default page now.");
-			std::ostringstream html;
-			html << "<!DOCTYPE html>\n"
-			     << "<html>\n"
-			     << "<head>\n"
-			     << "<title>" << code << " DX</title>\n"
-			     << "<style>\n"
-			     << "@import "
-			        "url('https://fonts.googleapis.com/"
-			        "css2?family=Space+Mono:ital,wght@0,400;0,700;1,400;1,700&display=swap'"
-			        ");\n"
-			     << "body { font-family: \"Space Mono\", monospace; text-align: center; "
-			        "background-color: "
-			        "#f8f9fa; "
-			        "margin: 0; padding: 0; }\n"
-			     << "h1 { color: #ff5555; margin-top: 50px; font-weight: 700; font-style: "
-			        "normal; }\n"
-			     << "p { color: #6c757d; font-size: 18px; }"
-			     << "footer { color: #dcdcdc; position: "
-			        "fixed; width: 100%; margin-top: 50px; }\n"
-			     << "</style>\n"
-			     << "</head>\n"
-			     << "<body>\n"
-			     << "<h1>Error " << code << ": " << reason_phrase << "</h1>\n"
-			     << "<p>The server encountered an issue and could not complete your "
-			        "request.</p>\n"
-			     << "<a href=\"https://developer.mozilla.org/en-US/docs/Web/HTTP/Reference/Status/"
-			     << code << "\" target=\"_blank\" rel=\"noopener noreferrer\">MDN Web Docs - "
-			     << code << "</a>"
-			     << "<footer>" << __WEBSERV_VERSION__ << "</footer>"
-			     << "</body>\n"
-			     << "</html>\n";
-			body = html.str();
-			setContentLength(body.length());
-			setContentType("text/html");
-			tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
-			                       "Content-Type set to: " + headers["Content-Type"]);
-		}
+	if (code >= 400 && body.empty()) {
+		tmplogg_.logWithPrefix(Logger::DEBUG, "Response",
+		                       "Generating the default page for " + su::to_string(code));
+		body = defaultErrorPage(code);
+		setContentLength(body.length());
+		setContentType("text/html");
 	}
 }
+
+std::string Response::defaultErrorPage(uint16_t code) {
+	const char *reason = ResponseWriter::reasonPhrase(code);
+	std::ostringstream html;
+	html << "<!DOCTYPE html>\n"
+	     << "<html>\n"
+	     << "<head>\n"
+	     << "<title>" << code << " DX</title>\n"
+	     << "<style>\n"
+	     << "@import "
+	        "url('https://fonts.googleapis.com/"
+	        "css2?family=Space+Mono:ital,wght@0,400;0,700;1,400;1,700&display=swap'"
+	        ");\n"
+	     << "body { font-family: \"Space Mono\", monospace; text-align: center; "
+	        "background-color: "
+	        "#f8f9fa; "
+	        "margin: 0; padding: 0; }\n"
+	     << "h1 { color: #ff5555; margin-top: 50px; font-weight: 700; font-style: "
+	        "normal; }\n"
+	     << "p { color: #6c757d; font-size: 18px; }"
+	     << "footer { color: #dcdcdc; position: "
+	        "fixed; width: 100%; margin-top: 50px; }\n"
+	     << "</style>\n"
+	     << "</head>\n"
+	     << "<body>\n"
+	     << "<h1>Error " << code << ": " << (reason ? reason : "Unknown Status") << "</h1>\n"
+	     << "<p>The server encountered an issue and could not complete your "
+	        "request.</p>\n"
+	     << "<a href=\"https://developer.mozilla.org/en-US/docs/Web/HTTP/Reference/Status/"
+	     << code << "\" target=\"_blank\" rel=\"noopener noreferrer\">MDN Web Docs - "
+	     << code << "</a>"
+	     << "<footer>" << __WEBSERV_VERSION__ << "</footer>"
+	     << "</body>\n"
+	     << "</html>\n";
+	return html.str();
+}
@@ -18,19 +18,40 @@
 #include "src/Utils/StringUtils.hpp"
 
 class Connection;
+struct CachedFile;
+struct SharedBuffer;
 
 class Response {
   public:
+	/// One part of a multipart/byteranges body: its headers (with the leading
+	/// boundary), then a range of body_file.
+	struct BodyPart {
+		std::string head;
+		off_t offset;
+		size_t length;
+	};
+
+	typedef std::vector<std::pair<std::string, std::string> > HeaderList;
+
 	std::string version;                        // HTTP/1.1
 	uint16_t status_code;                       // e.g. 200
 	std::string reason_phrase;                  // e.g. OK
-	std::map<std::string, std::string> headers; // e.g. Content-Type: text/html
+	HeaderList headers;                         // e.g. Content-Type: text/html, in order
 	std::string body;                           // e.g. <h1>Hello world!</h1>
+	CachedFile *body_file; // file sent after body if set (a reference is held)
+	off_t body_offset;     // first byte of the file to send
+	size_t body_length;    // bytes of the file to send
+	bool body_mapped;      // body_file is sent from its mapping rather than with sendfile()
+	std::vector<BodyPart> body_parts; // multipart/byteranges, sent before body if not empty
+	SharedBuffer *cached;  // serialized headers and body sent as is if set (a reference is held)
 
 	Response();
 	explicit Response(uint16_t code);
 	explicit Response(uint16_t code, const std::string &response_body);
 	explicit Response(uint16_t code, Connection *conn); // custom error pages
+	Response(const Response &other);
+	Response &operator=(const Response &other);
+	~Response();
 
 	inline void setStatus(uint16_t code) {
 		status_code = code;
@@ -40,15 +61,41 @@ class Response {
 		}
 	}
 
-	inline void setHeader(const std::string &name, const std::string &value) {
-		headers[name] = value;
-	}
+	/// Sets a header, replacing the value of one with the same name.
+	void setHeader(const std::string &name, const std::string &value);
 
-	inline void setContentType(const std::string &ctype) { headers["Content-Type"] = ctype; }
+	/// \returns The value of a header, NULL if not set.
+	const std::string *getHeader(const std::string &name) const;
 
-	inline void setContentLength(size_t length) {
-		headers["Content-Length"] = su::to_string(length);
-	}
+	inline void setContentType(const std::string &ctype) { setHeader("Content-Type", ctype); }
+
+	void setContentLength(size_t length);
+
+	/// Makes a range of a file the body, sent after the headers (and after
+	/// body, which is usually empty). The response holds a reference on the
+	/// file until it is destroyed; the output queue takes its own.
+	/// \param file The file, from the open-file cache or FileCache::open().
+	/// \param offset First byte of the range.
+	/// \param length Number of bytes, also announced as Content-Length.
+	/// \param mapped Send it from the file's mapping (which must exist, see
+	///               CachedFile::mapping()) rather than with sendfile().
+	void setBodyFile(CachedFile *file, off_t offset, size_t length, bool mapped = false);
+
+	/// Replaces the headers and body with serialized ones from the static
+	/// cache, holding a reference on them. Only the status line and the Date
+	/// header are still written per response.
+	/// \param response The serialized headers and body.
+	void setCachedResponse(SharedBuffer *response);
+
+	/// Appends the status line, a Date header (if given), the headers and the
+	/// blank line that ends them.
+	/// \param out Buffer to append to.
+	/// \param date "Date: ...\r\n" line, see DateHeader, or empty.
+	void writeHead(std::string &out, const std::string &date) const;
+
+	/// Appends the headers and the blank line, without status line.
+	/// \param out Buffer to append to.
+	void writeHeaders(std::string &out) const;
 
 	std::string toString() const;
 	std::string toStringHeadersOnly() const;
@@ -73,6 +120,11 @@ class Response {
 	static Response notImplemented(Connection *conn);
 	static Response forbidden(Connection *conn);
 
+	/// Builds the page sent for an error without a custom one.
+	/// \param code Status code (4xx or 5xx).
+	/// \returns The HTML.
+	static std::string defaultErrorPage(uint16_t code);
+
   private:
 	std::string getReasonPhrase(uint16_t code) const;
 	void initFromStatusCode(uint16_t code);
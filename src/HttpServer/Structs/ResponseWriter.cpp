@@ -0,0 +1,122 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ResponseWriter.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/31 09:12:44 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/31 09:12:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ResponseWriter.hpp"
+#include "src/Utils/GeneralUtils.hpp"
+
+struct StatusLine {
+	uint16_t code;
+	const char *reason;
+	const char *line;
+	size_t length;
+};
+
+#define STATUS_LINE(code, reason)                                                                 \
+	{ code, reason, "HTTP/1.1 " #code " " reason "\r\n",                                          \
+	  sizeof("HTTP/1.1 " #code " " reason "\r\n") - 1 }
+
+// Sorted by code
+static const StatusLine status_lines[] = {
+    STATUS_LINE(100, "Continue"),
+    STATUS_LINE(200, "OK"),
+    STATUS_LINE(201, "Created"),
+    STATUS_LINE(204, "No Content"),
+    STATUS_LINE(206, "Partial Content"),
+    STATUS_LINE(301, "Moved Permanently"),
+    STATUS_LINE(302, "Found"),
+    STATUS_LINE(304, "Not Modified"),
+    STATUS_LINE(400, "Bad Request"),
+    STATUS_LINE(401, "Unauthorized"),
+    STATUS_LINE(403, "Forbidden"),
+    STATUS_LINE(404, "Not Found"),
+    STATUS_LINE(405, "Method Not Allowed"),
+    STATUS_LINE(408, "Request Timeout"),
+    STATUS_LINE(413, "Content Too Large"),
+    STATUS_LINE(414, "URI Too Long"),
+    STATUS_LINE(416, "Range Not Satisfiable"),
+    STATUS_LINE(431, "Request Header Fields Too Large"),
+    STATUS_LINE(500, "Internal Server Error"),
+    STATUS_LINE(501, "Not Implemented"),
+    STATUS_LINE(502, "Bad Gateway"),
+    STATUS_LINE(503, "Service Unavailable"),
+    STATUS_LINE(504, "Gateway Timeout"),
+    STATUS_LINE(505, "HTTP Version Not Supported"),
+};
+
+#undef STATUS_LINE
+
+static const size_t status_count = sizeof(status_lines) / sizeof(status_lines[0]);
+
+static const StatusLine *findStatus(uint16_t code) {
+	size_t low = 0;
+	size_t high = status_count;
+	while (low < high) {
+		size_t mid = (low + high) / 2;
+		if (status_lines[mid].code < code)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	if (low < status_count && status_lines[low].code == code)
+		return &status_lines[low];
+	return NULL;
+}
+
+bool ResponseWriter::appendStatusLine(std::string &out, uint16_t code) {
+	const StatusLine *status = findStatus(code);
+	if (!status)
+		return false;
+	out.append(status->line, status->length);
+	return true;
+}
+
+const char *ResponseWriter::reasonPhrase(uint16_t code) {
+	const StatusLine *status = findStatus(code);
+	return status ? status->reason : NULL;
+}
+
+void ResponseWriter::appendHeader(std::string &out, const std::string &name,
+                                  const std::string &value) {
+	out.append(name);
+	out.append(": ", 2);
+	out.append(value);
+	out.append("\r\n", 2);
+}
+
+void ResponseWriter::appendNumber(std::string &out, size_t n) {
+	char digits[24];
+	char *end = digits + sizeof(digits);
+	char *p = end;
+	do {
+		*--p = static_cast<char>('0' + n % 10);
+		n /= 10;
+	} while (n > 0);
+	out.append(p, end - p);
+}
+
+std::string ResponseWriter::numberToString(size_t n) {
+	std::string out;
+	appendNumber(out, n);
+	return out;
+}
+
+DateHeader::DateHeader()
+    : _second(-1) {}
+
+const std::string &DateHeader::line() {
+	time_t now = time(NULL);
+	if (now != _second) {
+		_second = now;
+		_line = "Date: " + httpDate(now) + "\r\n";
+	}
+	return _line;
+}
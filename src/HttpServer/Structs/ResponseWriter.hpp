@@ -0,0 +1,55 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ResponseWriter.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/31 09:12:44 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/31 09:12:44 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef RESPONSEWRITER_HPP
+#define RESPONSEWRITER_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Building blocks to serialize a response head by appending to a string,
+/// without streams or temporaries.
+class ResponseWriter {
+  public:
+	/// Appends "HTTP/1.1 <code> <reason>\r\n", copied from a preformatted table.
+	/// \param out Buffer to append to.
+	/// \param code Status code.
+	/// \returns False if the code is not in the table (nothing is appended).
+	static bool appendStatusLine(std::string &out, uint16_t code);
+
+	/// \returns The reason phrase of a status code, NULL if unknown.
+	static const char *reasonPhrase(uint16_t code);
+
+	/// Appends "name: value\r\n".
+	static void appendHeader(std::string &out, const std::string &name, const std::string &value);
+
+	/// Appends a number in decimal.
+	static void appendNumber(std::string &out, size_t n);
+
+	/// \returns A number in decimal, without going through a stream.
+	static std::string numberToString(size_t n);
+};
+
+/// The "Date: ...\r\n" line of the current second, formatted again only when
+/// the second changes. One per event loop, so it needs no locking.
+class DateHeader {
+  public:
+	DateHeader();
+
+	/// \returns The header line for now.
+	const std::string &line();
+
+  private:
+	time_t _second;
+	std::string _line;
+};
+
+#endif
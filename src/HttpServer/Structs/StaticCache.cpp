@@ -0,0 +1,127 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   StaticCache.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/27 09:20:05 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/27 09:20:05 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "StaticCache.hpp"
+
+StaticCache::StaticCache(size_t max_bytes, size_t max_file)
+    : _max_bytes(max_bytes),
+      _max_file(max_file),
+      _bytes(0),
+      _hits(0),
+      _misses(0),
+      _stale(0),
+      _evictions(0) {}
+
+StaticCache::~StaticCache() { clear(); }
+
+// Not the resolved path: the Content-Type in the headers comes from the name
+// that was asked for, and two links to one file may not share it
+std::string StaticCache::key(const CachedFile &file, const std::string &encoding) {
+	return encoding.empty() ? file.path : file.path + ";" + encoding;
+}
+
+SharedBuffer *StaticCache::find(const CachedFile &file, const std::string &encoding) {
+	Index::iterator it = _index.find(key(file, encoding));
+	if (it == _index.end()) {
+		++_misses;
+		return NULL;
+	}
+	Entry &entry = it->second;
+	if (entry.inode != file.inode || entry.size != file.size || entry.mtime != file.mtime) {
+		++_stale;
+		remove(it);
+		return NULL;
+	}
+	++_hits;
+	_lru.splice(_lru.begin(), _lru, entry.lru);
+	return entry.response;
+}
+
+SharedBuffer *StaticCache::insert(const CachedFile &file, const std::string &head,
+                                  const std::string &encoding) {
+	size_t size = static_cast<size_t>(file.size);
+	size_t total = head.size() + size;
+	if (file.fd == -1 || total > _max_bytes)
+		return NULL;
+
+	SharedBuffer *response = new SharedBuffer;
+	response->data.reserve(total);
+	response->data = head;
+	response->data.resize(total);
+	size_t done = 0;
+	while (done < size) {
+		ssize_t got = pread(file.fd, &response->data[head.size() + done], size - done,
+		                    static_cast<off_t>(done));
+		if (got <= 0) {
+			response->release(); // unreadable, or shorter than its size: serve it from disk
+			return NULL;
+		}
+		done += got;
+	}
+	return store(key(file, encoding), file, response);
+}
+
+SharedBuffer *StaticCache::insert(const CachedFile &file, const std::string &head,
+                                  const std::string &body, const std::string &encoding) {
+	if (head.size() + body.size() > _max_bytes)
+		return NULL;
+	SharedBuffer *response = new SharedBuffer;
+	response->data.reserve(head.size() + body.size());
+	response->data = head;
+	response->data += body;
+	return store(key(file, encoding), file, response);
+}
+
+SharedBuffer *StaticCache::store(const std::string &key, const CachedFile &file,
+                                 SharedBuffer *response) {
+	size_t total = response->data.size();
+	Index::iterator old = _index.find(key);
+	if (old != _index.end())
+		remove(old);
+	while (_bytes + total > _max_bytes && !_lru.empty()) {
+		++_evictions;
+		remove(_index.find(_lru.back()));
+	}
+
+	_lru.push_front(key);
+	Entry &entry = _index[key];
+	entry.response = response;
+	entry.inode = file.inode;
+	entry.size = file.size;
+	entry.mtime = file.mtime;
+	entry.lru = _lru.begin();
+	_bytes += total;
+	return response;
+}
+
+void StaticCache::remove(Index::iterator it) {
+	_bytes -= it->second.response->data.size();
+	it->second.response->release();
+	_lru.erase(it->second.lru);
+	_index.erase(it);
+}
+
+void StaticCache::clear() {
+	while (!_index.empty())
+		remove(_index.begin());
+}
+
+StaticCache::Stats StaticCache::stats() const {
+	Stats stats;
+	stats.hits = _hits;
+	stats.misses = _misses;
+	stats.stale = _stale;
+	stats.evictions = _evictions;
+	stats.entries = _index.size();
+	stats.bytes = _bytes;
+	return stats;
+}
@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   StaticCache.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/27 09:20:05 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/27 09:20:05 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef STATICCACHE_HPP
+#define STATICCACHE_HPP
+
+#include "includes/Webserv.hpp"
+#include "FileCache.hpp"
+#include "OutputQueue.hpp"
+
+/// Serialized responses (headers and body) of small static files, kept in
+/// memory so that a hit is queued as one shared buffer and written with a
+/// single send.
+///
+/// Entries are keyed by requested path, plus the content coding of a compressed
+/// variant, and remember the inode, size and mtime the response was built
+/// from; a lookup whose CachedFile (revalidated by the open-file cache) no
+/// longer matches drops the entry. The total size of the buffers is bounded,
+/// the least recently used ones are evicted first.
+class StaticCache {
+  public:
+	/// Counters, see stats().
+	struct Stats {
+		unsigned long hits;
+		unsigned long misses;
+		unsigned long stale;     ///< Entries dropped because the file changed
+		unsigned long evictions; ///< Entries dropped to stay within max_bytes
+		size_t entries;
+		size_t bytes;
+	};
+
+	/// \param max_bytes Budget for all the responses, 0 disables the cache.
+	/// \param max_file Largest file that is cached.
+	StaticCache(size_t max_bytes, size_t max_file);
+	~StaticCache();
+
+	/// \returns Whether the response of a file of this size would be cached.
+	inline bool accepts(off_t size) const {
+		return _max_bytes > 0 && static_cast<size_t>(size) <= _max_file;
+	}
+
+	/// Finds the response of a file.
+	/// \param file The file, as currently known by the open-file cache.
+	/// \param encoding Content coding of the body, empty for the file as is.
+	/// \returns The response, valid until the next insert() or clear(); the
+	///          output queue takes its own reference. NULL if not cached.
+	SharedBuffer *find(const CachedFile &file, const std::string &encoding = "");
+
+	/// Reads a file and caches its response.
+	/// \param file The file, open and small enough for accepts().
+	/// \param head The serialized headers, up to the blank line (the status
+	///             line and Date are written per response).
+	/// \param encoding Content coding of a precompressed file, sent as is.
+	/// \returns The response, or NULL if the file could not be read.
+	SharedBuffer *insert(const CachedFile &file, const std::string &head,
+	                     const std::string &encoding = "");
+
+	/// Caches a response whose body was derived from a file (compressed).
+	/// \param file The file the body was made from.
+	/// \param head The serialized headers, up to the blank line (the status
+	///             line and Date are written per response).
+	/// \param body The body.
+	/// \param encoding Its content coding.
+	/// \returns The response, or NULL if it does not fit in the cache.
+	SharedBuffer *insert(const CachedFile &file, const std::string &head, const std::string &body,
+	                     const std::string &encoding);
+
+	/// Drops every response. Those still queued are freed once written.
+	void clear();
+
+	inline bool enabled() const { return _max_bytes > 0; }
+
+	Stats stats() const;
+
+  private:
+	struct Entry {
+		SharedBuffer *response;
+		ino_t inode;
+		off_t size;
+		time_t mtime;
+		std::list<std::string>::iterator lru;
+	};
+	typedef std::map<std::string, Entry> Index;
+
+	size_t _max_bytes;
+	size_t _max_file;
+	size_t _bytes;                // size of the cached responses
+	Index _index;                 // resolved path[;coding] -> response
+	std::list<std::string> _lru;  // keys, most recently used first
+	unsigned long _hits;
+	unsigned long _misses;
+	unsigned long _stale;
+	unsigned long _evictions;
+
+	StaticCache(const StaticCache &);
+	StaticCache &operator=(const StaticCache &);
+
+	static std::string key(const CachedFile &file, const std::string &encoding);
+	SharedBuffer *store(const std::string &key, const CachedFile &file, SharedBuffer *response);
+	void remove(Index::iterator it);
+};
+
+#endif
@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/21 09:30:12 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/21 09:30:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "TimerWheel.hpp"
+
+TimerWheel::TimerWheel()
+    : _tick(now() / TICK_MS),
+      _count(0) {
+	for (size_t i = 0; i < SLOTS; ++i) {
+		_slots[i].prev = &_slots[i];
+		_slots[i].next = &_slots[i];
+	}
+}
+
+uint64_t TimerWheel::now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
+
+void TimerWheel::schedule(Node *node, uint64_t deadline) {
+	if (node->armed())
+		unlink(node);
+
+	// First tick at or after the deadline; one that already passed fires on the next tick
+	uint64_t tick = (deadline + TICK_MS - 1) / TICK_MS;
+	if (tick <= _tick)
+		tick = _tick + 1;
+
+	Node *head = &_slots[tick % SLOTS];
+	node->deadline = deadline;
+	node->prev = head->prev;
+	node->next = head;
+	head->prev->next = node;
+	head->prev = node;
+	++_count;
+}
+
+void TimerWheel::cancel(Node *node) {
+	if (node->armed())
+		unlink(node);
+}
+
+void TimerWheel::unlink(Node *node) {
+	node->prev->next = node->next;
+	node->next->prev = node->prev;
+	node->prev = NULL;
+	node->next = NULL;
+	--_count;
+}
+
+void TimerWheel::advance(uint64_t now, std::vector<void *> &expired) {
+	uint64_t target = now / TICK_MS;
+	if (target <= _tick)
+		return;
+
+	// After a long stall every slot is due: visit each one once
+	uint64_t ticks = target - _tick;
+	if (ticks > SLOTS)
+		ticks = SLOTS;
+
+	for (uint64_t t = 1; t <= ticks; ++t) {
+		Node *head = &_slots[(_tick + t) % SLOTS];
+		Node *node = head->next;
+		while (node != head) {
+			Node *next = node->next;
+			if (node->deadline <= now) {
+				unlink(node);
+				expired.push_back(node->data);
+			}
+			node = next;
+		}
+	}
+	_tick = target;
+}
+
+int TimerWheel::nextTimeout(uint64_t now) const {
+	if (_count == 0)
+		return -1;
+
+	for (size_t t = 1; t <= SLOTS; ++t) {
+		const Node *head = &_slots[(_tick + t) % SLOTS];
+		if (head->next != head) {
+			uint64_t due = (_tick + t) * TICK_MS;
+			return due > now ? static_cast<int>(due - now) : 0;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,84 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/21 09:30:12 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/21 09:30:12 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Hashed timing wheel for connection timeouts.
+///
+/// Timers are intrusive nodes (one per connection) kept in the slot of their
+/// deadline tick, so arming, re-arming and cancelling are O(1). Advancing the
+/// wheel only visits the slots of the ticks that elapsed; a timer whose
+/// deadline is more than one turn away simply stays in its slot until then.
+class TimerWheel {
+  public:
+	/// A timer, embedded in the object it belongs to.
+	struct Node {
+		Node *prev;
+		Node *next;
+		uint64_t deadline; ///< Monotonic milliseconds
+		void *data;        ///< Owner of the timer, returned on expiry
+
+		Node()
+		    : prev(NULL),
+		      next(NULL),
+		      deadline(0),
+		      data(NULL) {}
+
+		inline bool armed() const { return next != NULL; }
+	};
+
+	TimerWheel();
+
+	/// Arms (or re-arms) a timer.
+	/// \param node The timer.
+	/// \param deadline Expiry time in monotonic milliseconds.
+	void schedule(Node *node, uint64_t deadline);
+
+	/// Disarms a timer. Does nothing if it is not armed.
+	/// \param node The timer.
+	void cancel(Node *node);
+
+	/// Moves the wheel to the given time and disarms every timer that expired.
+	/// \param now Current monotonic milliseconds.
+	/// \param expired Receives the data of the expired timers.
+	void advance(uint64_t now, std::vector<void *> &expired);
+
+	/// Time until the first non-empty slot, to be used as epoll_wait timeout.
+	/// May be early when that slot only holds timers of a later turn.
+	/// \param now Current monotonic milliseconds.
+	/// \returns Milliseconds to wait, or -1 when no timer is armed.
+	int nextTimeout(uint64_t now) const;
+
+	/// \returns Number of armed timers.
+	inline size_t size() const { return _count; }
+
+	/// \returns The monotonic clock in milliseconds.
+	static uint64_t now();
+
+	static const uint64_t TICK_MS = 100;
+	static const size_t SLOTS = 512; // one turn = 51.2 seconds
+
+  private:
+	Node _slots[SLOTS]; // list heads (circular, sentinel)
+	uint64_t _tick;     // last tick processed by advance()
+	size_t _count;
+
+	TimerWheel(const TimerWheel &);
+	TimerWheel &operator=(const TimerWheel &);
+
+	void unlink(Node *node);
+};
+
+#endif
@@ -14,17 +14,31 @@
 #include "src/HttpServer/Structs/Connection.hpp"
 #include "src/HttpServer/Structs/Response.hpp"
 #include "src/HttpServer/HttpServer.hpp"
+#include "src/Utils/MimeTypes.hpp"
 
-bool WebServer::_running;
-static bool interrupted = false;
-uint16_t g_error_status = 0;
+volatile bool WebServer::_running;
+volatile sig_atomic_t WebServer::_stats_requested = 0;
+const size_t WebServer::MAX_CHUNK_LINE;
+static volatile bool interrupted = false;
+__thread uint16_t g_error_status = 0;
 
 
 WebServer::WebServer(std::vector<ServerConfig> &confs)
     : _epoll_fd(-1),
       _backlog(SOMAXCONN),
       _confs(confs),
-      _lggr("ws.log", Logger::DEBUG, true) {
+      _lggr("ws.log", Logger::DEBUG, true),
+      _files(_global.getOpenFileCache(), _global.getOpenFileCacheValid() * 1000),
+      _responses(_global.getStaticCacheMaxBytes(), _global.getStaticCacheMaxFile()),
+      _worker_id(-1),
+      _owner(NULL),
+      _loop_id(-1),
+      _handoff_fd(-1),
+      _load(0),
+      _next_loop(0),
+      _reserve_fd(-1) {
+	std::memset(&_accept_stats, 0, sizeof(_accept_stats));
+	_stats_seen = _stats_requested;
 	_lggr.info("An instance of the Webserver was created.");
 }
 
@@ -34,13 +48,97 @@ WebServer::WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path)
       _backlog(SOMAXCONN),
       _root_prefix_path(prefix_path),
       _confs(confs),
-      _lggr("ws.log", Logger::DEBUG, true) {
+      _lggr("ws.log", Logger::DEBUG, true),
+      _files(_global.getOpenFileCache(), _global.getOpenFileCacheValid() * 1000),
+      _responses(_global.getStaticCacheMaxBytes(), _global.getStaticCacheMaxFile()),
+      _worker_id(-1),
+      _owner(NULL),
+      _loop_id(-1),
+      _handoff_fd(-1),
+      _load(0),
+      _next_loop(0),
+      _reserve_fd(-1) {
+	std::memset(&_accept_stats, 0, sizeof(_accept_stats));
+	_stats_seen = _stats_requested;
 	_lggr.info("An instance of the Webserver was created.");
 }
 
+WebServer::WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path,
+                     const GlobalConfig &global)
+    : _epoll_fd(-1),
+      _backlog(SOMAXCONN),
+      _root_prefix_path(prefix_path),
+      _global(global),
+      _confs(confs),
+      _lggr("ws.log", Logger::DEBUG, true),
+      _files(_global.getOpenFileCache(), _global.getOpenFileCacheValid() * 1000),
+      _responses(_global.getStaticCacheMaxBytes(), _global.getStaticCacheMaxFile()),
+      _worker_id(-1),
+      _owner(NULL),
+      _loop_id(-1),
+      _handoff_fd(-1),
+      _load(0),
+      _next_loop(0),
+      _reserve_fd(-1) {
+	std::memset(&_accept_stats, 0, sizeof(_accept_stats));
+	_stats_seen = _stats_requested;
+	_lggr.info("An instance of the Webserver was created.");
+}
+
+WebServer::WebServer(WebServer *owner, int loop_id)
+    : _epoll_fd(-1),
+      _backlog(owner->_backlog),
+      _root_prefix_path(owner->_root_prefix_path),
+      _global(owner->_global),
+      _lggr("ws.log", Logger::DEBUG, true),
+      _files(_global.getOpenFileCache(), _global.getOpenFileCacheValid() * 1000),
+      _responses(_global.getStaticCacheMaxBytes(), _global.getStaticCacheMaxFile()),
+      _worker_id(owner->_worker_id),
+      _owner(owner),
+      _loop_id(loop_id),
+      _handoff_fd(-1),
+      _load(0),
+      _next_loop(0),
+      _reserve_fd(-1) {
+	std::memset(&_accept_stats, 0, sizeof(_accept_stats));
+	_stats_seen = _stats_requested;
+	pthread_mutex_init(&_handoff_lock, NULL);
+	_lggr.debug("Event loop " + su::to_string(loop_id) + " was created.");
+}
+
 WebServer::~WebServer() {
 	_lggr.debug("Destroying Webserver instance.");
 	cleanup();
+	if (_owner)
+		pthread_mutex_destroy(&_handoff_lock);
+}
+
+void WebServer::loadErrorPages() {
+	std::string prefix = (su::back(_root_prefix_path) == '/')
+	                         ? _root_prefix_path.substr(0, _root_prefix_path.length() - 1)
+	                         : _root_prefix_path;
+	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
+		it->setPrefix(_root_prefix_path);
+		// The default page of every error the server can send
+		for (uint16_t code = 400; code < 600; ++code) {
+			if (ResponseWriter::reasonPhrase(code))
+				it->setErrorBody(code, Response::defaultErrorPage(code), "text/html");
+		}
+		const std::map<uint16_t, std::string> &pages = it->getErrorPages();
+		for (std::map<uint16_t, std::string>::const_iterator page = pages.begin();
+		     page != pages.end(); ++page) {
+			std::string path = prefix + page->second;
+			std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+			if (!file.is_open()) {
+				_lggr.warn("Custom error page " + path + " could not be opened, using the default");
+				continue;
+			}
+			std::ostringstream content;
+			content << file.rdbuf();
+			it->setErrorBody(page->first, content.str(), mimeType(path).type);
+			_lggr.debug("Loaded error page " + su::to_string(page->first) + " from " + path);
+		}
+	}
 }
 
 bool WebServer::initialize() {
@@ -52,6 +150,13 @@ bool WebServer::initialize() {
 		_lggr.error("No server configurations provided. Cannot initialize WebServer");
 		return false;
 	}
+	loadErrorPages();
+
+	// Each worker opens its own epoll instance and listeners after the fork
+	if (_global.getWorkerProcesses() > 1) {
+		_running = true;
+		return true;
+	}
 
 	if (!createEpollInstance()) {
 		return false;
@@ -62,26 +167,45 @@ bool WebServer::initialize() {
 			return false;
 		}
 	}
+	if (!openReserveFd()) {
+		return false;
+	}
+	_accept_stats.since = getCurrentTime();
 
 	_running = true;
+	if (!startEventLoops()) {
+		_running = false;
+		return false;
+	}
 	return true;
 }
 
 void WebServer::run() {
+	if (_global.getWorkerProcesses() > 1) {
+		runMaster();
+		return;
+	}
+	runEventLoop();
+	_running = false;
+	stopEventLoops();
+}
+
+void WebServer::runEventLoop() {
 	struct epoll_event events[MAX_EVENTS];
-	_last_cleanup = getCurrentTime();
 
 	_lggr.debug("Server running. Waiting for connections...");
 
 	while (_running) {
-		int event_count = epoll_wait(_epoll_fd, events, MAX_EVENTS, 100);
+		// Do not sleep while edge-triggered connections still have data waiting
+		int timeout = _io_ready.empty() ? nextEpollTimeout() : 0;
+		int event_count = epoll_wait(_epoll_fd, events, MAX_EVENTS, timeout);
 
-		if (event_count == -1 && !interrupted) {
-			_lggr.error("epoll_wait failed: " + std::string(strerror(errno)));
-			break;
-		} else if (event_count == -1 && interrupted) {
+		if (event_count == -1 && interrupted) {
 			_lggr.warn("Program interrupted, shutting down...");
 			break;
+		} else if (event_count == -1 && errno != EINTR) {
+			_lggr.error("epoll_wait failed: " + std::string(strerror(errno)));
+			break;
 		}
 
 		if (event_count > 0) {
@@ -92,9 +216,17 @@ void WebServer::run() {
 				           "), may have more events pending");
 			}
 		}
+		if (!_io_ready.empty())
+			processReadyConnections();
+
+		expireTimers();
 
-		cleanupExpiredConnections();
+		if (_stats_seen != _stats_requested) {
+			_stats_seen = _stats_requested;
+			logStats();
+		}
 	}
+	logStats();
 
 	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
 		if (it->getServerFD() != -1) {
@@ -109,19 +241,36 @@ void sigint_handler(int sig) {
 	interrupted = true;
 }
 
+void sigusr1_handler(int sig) {
+	(void)sig;
+	++WebServer::_stats_requested;
+}
+
 bool WebServer::setupSignalHandlers() {
 	_lggr.debug("Setting up signal handlers");
 
-	if (signal(SIGINT, &sigint_handler) == SIG_ERR) {
+	// No SA_RESTART: the master must wake up from waitpid() when asked to stop
+	struct sigaction sa;
+	std::memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = &sigint_handler;
+	sigemptyset(&sa.sa_mask);
+
+	if (sigaction(SIGINT, &sa, NULL) == -1) {
 		_lggr.error("Failed to set SIGINT handler");
 		return false;
 	}
 
-	if (signal(SIGTERM, &sigint_handler) == SIG_ERR) {
+	if (sigaction(SIGTERM, &sa, NULL) == -1) {
 		_lggr.error("Failed to set SIGTERM handler");
 		return false;
 	}
 
+	sa.sa_handler = &sigusr1_handler;
+	if (sigaction(SIGUSR1, &sa, NULL) == -1) {
+		_lggr.error("Failed to set SIGUSR1 handler");
+		return false;
+	}
+
 	interrupted = false;
 	return true;
 }
@@ -180,6 +329,13 @@ bool WebServer::setSocketOptions(int socket_fd, const std::string &host, const i
 		                    "Failed to set SO_REUSEADDR option");
 		return false;
 	}
+	// Every worker binds its own listener; the kernel balances new connections between them
+	if (_global.getWorkerProcesses() > 1 &&
+	    setsockopt(socket_fd, SOL_SOCKET, SO_REUSEPORT, &reuse_addr, sizeof(reuse_addr)) == -1) {
+		_lggr.logWithPrefix(Logger::ERROR, host + ":" + su::to_string<int>(port),
+		                    "Failed to set SO_REUSEPORT option");
+		return false;
+	}
 	return true;
 }
 
@@ -239,6 +395,10 @@ bool WebServer::epollManage(int op, int socket_fd, uint32_t events) {
 	return true;
 }
 
+uint32_t WebServer::clientEvents(uint32_t events) const {
+	return _global.isEdgeTriggered() ? (events | EPOLLET) : events;
+}
+
 bool WebServer::initializeSingleServer(ServerConfig &config) {
 	struct addrinfo *addr_info = NULL;
 
@@ -260,6 +420,7 @@ bool WebServer::initializeSingleServer(ServerConfig &config) {
 		freeaddrinfo(addr_info);
 		return false;
 	}
+	_fds.addListener(config.getServerFD(), &config);
 
 	freeaddrinfo(addr_info);
 	_lggr.logWithPrefix(Logger::INFO, config.getHost() + ":" + su::to_string<int>(config.getPort()),
@@ -272,15 +433,29 @@ void WebServer::cleanup() {
 	_lggr.debug("Performing server cleanup...");
 
 	// Close all client connections
-	for (std::map<int, Connection *>::iterator it = _connections.begin(); it != _connections.end();
-	     ++it) {
-		close(it->first);
-		delete it->second;
+	for (int fd = 0; fd < _fds.size(); ++fd) {
+		if (Connection *conn = _fds.connection(fd)) {
+			abortCGI(conn);
+			_fds.remove(fd);
+			_timers.cancel(&conn->timer);
+			close(fd);
+			_pool.release(conn);
+		}
+	}
+
+	// Sockets the acceptor handed over but the loop never picked up
+	for (size_t i = 0; i < _handoff_queue.size(); ++i) {
+		close(_handoff_queue[i].first);
+	}
+	_handoff_queue.clear();
+	if (_handoff_fd != -1) {
+		close(_handoff_fd);
+		_handoff_fd = -1;
 	}
-	_connections.clear();
 
 	for (std::vector<ServerConfig>::iterator it = _confs.begin(); it != _confs.end(); ++it) {
 		if (it->getServerFD() != -1) {
+			_fds.remove(it->getServerFD());
 			close(it->getServerFD());
 			it->setServerFD(-1);
 		}
@@ -290,6 +465,10 @@ void WebServer::cleanup() {
 		close(_epoll_fd);
 		_epoll_fd = -1;
 	}
+	if (_reserve_fd != -1) {
+		close(_reserve_fd);
+		_reserve_fd = -1;
+	}
 
 	_lggr.info("Server cleanup completed");
 }
@@ -319,15 +498,21 @@ int main(int argc, char *argv[]) {
 
 	ConfigParser configparser;
 	std::vector<ServerConfig> servers;
+	GlobalConfig global;
 
-	if (!configparser.loadConfig(args.config_file, servers)) {
+	if (!configparser.loadConfig(args.config_file, servers, global)) {
 		std::cerr << "Error: Failed to open or parse configuration file '" << args.config_file
 		          << "'" << std::endl;
 		std::cerr << "Please check the configuration file syntax and try again." << std::endl;
 		return 1;
 	}
 
-	WebServer webserv(servers, args.prefix_path);
+	if (args.workers > 0)
+		global.setWorkerProcesses(args.workers);
+	if (args.threads > 0)
+		global.setWorkerThreads(args.threads);
+
+	WebServer webserv(servers, args.prefix_path, global);
 
 	if (!webserv.initialize()) {
 		std::cerr << "Failed to initialize web server." << std::endl;
@@ -14,7 +14,12 @@
 #define WEBSERVER2_HPP
 
 #include "Connection.hpp"
+#include "ConnectionPool.hpp"
+#include "FdTable.hpp"
+#include "FileCache.hpp"
 #include "Response.hpp"
+#include "ResponseWriter.hpp"
+#include "StaticCache.hpp"
 #include "src/HttpServer/HttpServer.hpp"
 #include "src/Logger/Logger.hpp"
 #include "includes/Types.hpp"
@@ -41,6 +46,14 @@ class WebServer {
 	/// \param prefix_path Root directory prefix for serving files.
 	WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path);
 
+	/// Constructs a WebServer with configurations, a root path prefix and the
+	/// process-wide settings (worker processes, ...).
+	/// \param confs Vector of server configurations to initialize.
+	/// \param prefix_path Root directory prefix for serving files.
+	/// \param global Settings from the main/http context and the command line.
+	WebServer(std::vector<ServerConfig> &confs, std::string &prefix_path,
+	          const GlobalConfig &global);
+
 	~WebServer();
 
 	/// Initializes all server sockets and prepares for accepting connections.
@@ -48,32 +61,85 @@ class WebServer {
 	bool initialize();
 
 	/// Starts the main event loop to handle client connections and requests.
+	/// With more than one worker process configured, the calling process becomes
+	/// the master and supervises the forked workers instead.
 	void run();
 
 	/// Global flag indicating if the server should continue running.
-	static bool _running;
+	/// Polled by every event-loop thread.
+	static volatile bool _running;
+
+	/// Bumped by SIGUSR1. Every instance whose _stats_seen differs logs its
+	/// counters on the next loop iteration.
+	static volatile sig_atomic_t _stats_requested;
 
   private:
 	int _epoll_fd;
 	int _backlog;
 	std::string _root_prefix_path;
+	GlobalConfig _global;
 
 	std::vector<ServerConfig> _confs;
 	std::vector<ServerConfig> _have_pending_conn;
 
-	static const int CONNECTION_TO = 30;   // seconds
-	static const int CLEANUP_INTERVAL = 5; // seconds
+	static const int MAX_EPOLL_TIMEOUT = 1000; // ms, so that a cleared _running is noticed
 	static const int BUFFER_SIZE = 4096 * 3;
+	static const int IO_BUDGET = 16; // recv/send calls per connection and wakeup (edge-triggered)
+	static const size_t MAX_CHUNK_LINE = 4096; // bytes of a chunk-size or trailer line
 
 	Logger _lggr;
 	static std::map<uint16_t, std::string> err_messages;
 
-	/// @brief List of all CGI Objects
-	std::map<int, std::pair<CGI *, Connection *> > _cgi_pool;
+	// What every watched fd is (listener, client, CGI pipe, wakeup), indexed by fd
+	FdTable _fds;
+	ConnectionPool _pool;   // owns every Connection of this instance
+	FileCache _files;       // open files and metadata of the paths served by this instance
+	StaticCache _responses; // complete responses of small hot files
+	DateHeader _date;       // Date line of every response, formatted once a second
+	sig_atomic_t _stats_seen;
 
 	// Connection management arguments
-	std::map<int, Connection *> _connections;
-	time_t _last_cleanup;
+	TimerWheel _timers; // header/body/keep-alive/send timeout of every connection
+	std::set<int> _io_ready; // edge-triggered connections that used their budget before EAGAIN
+
+	// Multi-worker mode (master process only)
+	static const int WORKER_INIT_FAILURE = 2; // exit status of a worker that could not start
+	static const int RESPAWN_DELAY = 1;       // seconds between respawns of a crashing worker
+	int _worker_id;                           // -1 in the master / single process
+	std::map<pid_t, int> _worker_pids;        // pid -> worker slot
+	std::vector<time_t> _worker_started;      // per slot, to throttle respawn loops
+
+	// Event-loop threads (worker_threads > 1). The instance that owns the
+	// listeners only accepts and hands the sockets over to the loops.
+	WebServer *_owner;                  // acceptor of this loop, NULL for the acceptor itself
+	int _loop_id;                       // -1 for the acceptor
+	pthread_t _thread;
+	int _handoff_fd;                    // eventfd signalled when sockets are queued
+	pthread_mutex_t _handoff_lock;      // guards _handoff_queue
+	std::deque<std::pair<int, const ServerConfig *> > _handoff_queue;
+	volatile int _load;                 // connections currently owned by this loop
+	std::vector<WebServer *> _loops;    // acceptor only
+	size_t _next_loop;                  // round-robin cursor used to break ties
+
+	// Accept path (instance that owns the listeners)
+	int _reserve_fd; // spare descriptor, released to shed connections on EMFILE
+	struct AcceptStats {
+		unsigned long accepted;     // connections accepted
+		unsigned long wakeups;      // listener events handled
+		unsigned long full_batches; // wakeups that used the whole accept_batch
+		unsigned long shed;         // connections dropped because we ran out of fds
+		unsigned long errors;       // other accept failures
+		time_t since;
+	} _accept_stats;
+
+	/// Constructs an event loop owned by the given acceptor. It shares the
+	/// acceptor's settings but has its own epoll instance and connections.
+	/// \param owner The instance that accepts connections for this loop.
+	/// \param loop_id Index of the loop, used in log messages.
+	WebServer(WebServer *owner, int loop_id);
+
+	WebServer(const WebServer &);
+	WebServer &operator=(const WebServer &);
 
 	// MEMBER FUNCTIONS
 
@@ -99,7 +165,8 @@ class WebServer {
 	/// \returns True on successful creation and configuration, false otherwise.
 	bool createAndConfigureSocket(ServerConfig &config, const struct addrinfo *addr_info);
 
-	/// Sets SO_REUSEADDR socket option to allow address reuse.
+	/// Sets SO_REUSEADDR socket option to allow address reuse, and SO_REUSEPORT
+	/// when several worker processes share the same listening address.
 	/// \param socket_fd The socket file descriptor to configure.
 	/// \param host The host address for logging purposes.
 	/// \param port The port number for logging purposes.
@@ -125,14 +192,74 @@ class WebServer {
 	/// \returns True on success, false on failure.
 	bool epollManage(int op, int socket_fd, uint32_t events);
 
+	/// Adds EPOLLET to a client socket mask when edge-triggered mode is on.
+	/// \param events The epoll events wanted for the client socket.
+	/// \returns The mask to register.
+	uint32_t clientEvents(uint32_t events) const;
+
 	/// Initializes a single server configuration.
 	/// \param config The server configuration to initialize.
 	/// \returns True on successful initialization, false otherwise.
 	bool initializeSingleServer(ServerConfig &config);
 
+	/// Reads the error_page files and builds the default error pages of every
+	/// server once, before any event loop runs; responses only copy them.
+	void loadErrorPages();
+
 	/// Performs cleanup of all server resources and connectioqns.
 	void cleanup();
 
+	/// Waits for events and dispatches them until the server is stopped.
+	void runEventLoop();
+
+	/* Handlers/Workers.cpp */
+
+	/// Forks the configured number of workers and respawns them when they die.
+	void runMaster();
+
+	/// Forks a worker process for the given slot.
+	/// \param slot Index of the worker (0 .. worker_processes - 1).
+	/// \returns True if the fork succeeded, false otherwise.
+	bool spawnWorker(int slot);
+
+	/// Body of a worker process: opens its own epoll instance and SO_REUSEPORT
+	/// listeners, serves until stopped and exits. Never returns.
+	void runWorker(int slot);
+
+	/// Sends SIGTERM to every worker and reaps them.
+	void stopWorkers();
+
+	/// Passes a SIGUSR1 received by the master on to every worker.
+	void forwardStatsRequest();
+
+	/* Handlers/EventLoops.cpp */
+
+	/// Starts the configured number of event-loop threads. Does nothing when
+	/// a single thread serves everything.
+	/// \returns True on success, false if a loop could not be set up.
+	bool startEventLoops();
+
+	/// Wakes every event-loop thread, joins it and releases its resources.
+	/// Must be called after _running has been cleared.
+	void stopEventLoops();
+
+	/// Thread entry point, runs the event loop of the given instance.
+	/// \param arg The WebServer instance of the loop.
+	static void *eventLoopMain(void *arg);
+
+	/// Picks the loop with the fewest connections, round-robin among equals.
+	/// \returns The loop the next connection should go to.
+	WebServer *pickEventLoop();
+
+	/// Queues an accepted socket for this loop and wakes it up.
+	/// Called from the acceptor thread.
+	/// \param client_fd The accepted, non-blocking client socket.
+	/// \param sc The configuration of the server that accepted it.
+	void handOff(int client_fd, const ServerConfig *sc);
+
+	/// Registers every socket queued by the acceptor with this loop.
+	void drainHandoffQueue();
+
 	/* Request.cpp */
 
 	void handleDirectoryRequest(ClientRequest &req, Connection *conn, bool end_slash);
@@ -141,8 +268,6 @@ class WebServer {
 	bool setupRequestContext(ClientRequest &req, Connection *conn);
 	void processValidRequest(ClientRequest &req, Connection *conn);
 
-	bool reconstructRequest(Connection *conn);
-
 	bool handleCGIRequest(ClientRequest &req, Connection *conn);
 
 	/// Handles cases where request size exceeds limits.
@@ -160,6 +285,13 @@ class WebServer {
 	/// \returns True if headers are complete, false otherwise.
 	bool isHeadersComplete(Connection *conn);
 
+	/// Moves the body bytes received so far (up to Content-Length) from the
+	/// read buffer to the body of the connection. Answers with a 500 if they
+	/// cannot be stored.
+	/// \param conn The connection reading a body.
+	/// \returns True once the whole body was received.
+	bool receiveBody(Connection *conn);
+
 	/// Determines if a complete HTTP request has been received.
 	/// \param conn The connection to check.
 	/// \returns True if request is complete, false if more data is needed.
@@ -187,63 +319,127 @@ class WebServer {
 	/// \returns File content as string, or empty string on error.
 	std::string getFileContent(std::string path);
 	FileType checkFileType(const std::string &path);
-	std::string buildFullPath(const std::string &uri, LocConfig *Location);
+	std::string buildFullPath(const std::string &uri, const LocConfig *Location);
 
 	// HANDLERS
 
 	/* Handlers/ChunkedReq.cpp */
 
+	/// Decodes the chunks received so far into the body of the connection.
+	/// Answers with a 400 if they are malformed, a 413 if they are too large.
+	/// \param conn The connection receiving chunked data.
+	/// \returns True once the last chunk and the trailers were received.
+	bool receiveChunks(Connection *conn);
+
+	/// Answers a malformed chunked body with a 400 and closes the connection.
+	/// \param conn The connection receiving chunked data.
+	/// \param reason What is wrong, for the log.
+	/// \param status 431 when the trailers are too large.
+	void handleBadChunk(Connection *conn, const std::string &reason, int status = 400);
+
+	/// Finds the end of the chunk-size or trailer line starting at pos, searching
+	/// only the bytes that arrived since the previous call.
+	/// \param conn The connection receiving chunked data.
+	/// \param pos Offset in the read buffer of the start of the line.
+	/// \returns The length of the line without its CRLF, or npos if it is not
+	///          complete yet or longer than MAX_CHUNK_LINE (answered with a 400).
+	size_t findChunkLine(Connection *conn, size_t pos);
+
 	/// Processes chunked transfer encoding chunk size line.
 	/// \param conn The connection receiving chunked data.
-	/// \returns True if chunk size was successfully parsed, false otherwise.
-	bool processChunkSize(Connection *conn);
+	/// \param pos Offset in the read buffer of the first byte not decoded yet, advanced.
+	/// \returns True if the state moved on, false if more data is needed or on error.
+	bool processChunkSize(Connection *conn, size_t &pos);
 
 	/// Processes chunked transfer encoding data chunks.
 	/// \param conn The connection receiving chunked data.
-	/// \returns True if chunk data was processed successfully, false otherwise.
-	bool processChunkData(Connection *conn);
+	/// \param pos Offset in the read buffer of the first byte not decoded yet, advanced.
+	/// \returns True if the state moved on, false if more data is needed or on error.
+	bool processChunkData(Connection *conn, size_t &pos);
 
 	/// Processes trailing headers in chunked transfer encoding.
 	/// \param conn The connection receiving chunked data.
-	/// \returns True if trailer was processed successfully, false otherwise.
-	bool processTrailer(Connection *conn);
-
-	/// Reconstructs a complete request from chunked transfer encoding.
-	/// \param conn The connection that received chunked data.
-	void reconstructChunkedRequest(Connection *conn);
+	/// \param pos Offset in the read buffer of the first byte not decoded yet, advanced.
+	/// \returns True if a line was read, false if more data is needed.
+	bool processTrailer(Connection *conn, size_t &pos);
 
 	/* Handlers/ServerCGI.cpp */
 	void sendCGIResponse(std::string &cgi_output, CGI *cgi, Connection *conn);
 	void normalResponse(CGI *cgi, Connection *conn);
 	void chunkedResponse(CGI *cgi, Connection *conn);
 	void handleCGIOutput(int fd);
-	bool isCGIFd(int fd) const;
 
 	/* Handlers/Connection.cpp */
 
 	void updateConnectionActivity(int client_fd);
 	
-	/// Accepts a new client connection and adds it to the connection pool.
+	/// Accepts up to accept_batch pending connections of a listener.
 	/// \param sc Pointer to the server configuration that received the connection.
-	void handleNewConnection(ServerConfig *sc);
+	void handleNewConnection(const ServerConfig *sc);
+
+	/// Registers an accepted socket with this instance, or with an event loop.
+	/// \param client_fd The accepted, non-blocking client socket.
+	/// \param sc The configuration of the server that accepted it.
+	/// \param client_addr Peer address, for logging.
+	void registerClient(int client_fd, const ServerConfig *sc, const struct sockaddr_in &client_addr);
+
+	/// Drops one pending connection when accept fails with EMFILE/ENFILE,
+	/// using the reserve descriptor.
+	/// \param sc The server whose listener ran out of descriptors.
+	void shedConnection(const ServerConfig *sc);
+
+	/// Opens the reserve descriptor used by shedConnection.
+	/// \returns True on success, false otherwise.
+	bool openReserveFd();
+
+	/// Logs the accept counters (on SIGUSR1 and at shutdown).
+	void logAcceptStats();
+
+	/// Logs the connection pool counters (on SIGUSR1 and at shutdown).
+	void logPoolStats();
+
+	/// Logs the open-file cache counters (on SIGUSR1 and at shutdown).
+	void logFileCacheStats();
+
+	/// Logs the static response cache counters (on SIGUSR1 and at shutdown).
+	void logStaticCacheStats();
+
+	/// Logs the counters of this instance: accept counters if it owns the
+	/// listeners, pool and cache counters if it serves connections.
+	void logStats();
 
 	/// Creates and registers a new client connection.
 	/// \param client_fd The client socket file descriptor.
 	/// \param sc The configuaration struct for the matching host:port server
 	/// \returns Pointer to the newly created Connection object.
-	Connection *addConnection(int client_fd, ServerConfig *sc);
+	Connection *addConnection(int client_fd, const ServerConfig *sc);
 
-	/// Closes expired connections to free resources.
-	void cleanupExpiredConnections();
+	/// Arms the connection timer for what the connection is doing now:
+	/// reading headers or body, idling between requests or sending.
+	/// \param conn The connection to update.
+	void refreshTimeout(Connection *conn);
 
-	/// Handles connection timeout by preparing appropriate response.
-	/// \param client_fd The file descriptor of the timed-out connection.
-	void handleConnectionTimeout(int client_fd);
+	/// Closes the connections whose timer expired.
+	void expireTimers();
 
-	/// Gracefully closes a client connection.
+	/// Time epoll_wait may block: until the next timer, at most MAX_EPOLL_TIMEOUT.
+	/// \returns Timeout in milliseconds.
+	int nextEpollTimeout() const;
+
+	/// Handles connection timeout, answering 408 if a request was in progress.
+	/// \param conn The timed-out connection.
+	void handleConnectionTimeout(Connection *conn);
+
+	/// Gracefully closes a client connection and returns it to the pool.
+	/// The connection must not be used after this call.
 	/// \param conn Pointer to the connection to close.
 	void closeConnection(Connection *conn);
 
+	/// Stops the CGI a connection is waiting for, if any: its pipe is
+	/// unregistered and closed and the child is killed and reaped.
+	/// \param conn The connection that started the CGI.
+	void abortCGI(Connection *conn);
+
 	/* Handlers/DirectoryReq.cpp */
 
 	/// Prepares response data when a directory is requested
@@ -276,25 +472,25 @@ class WebServer {
 
 	/* EpollEventHandler.cpp */
 
-	/// Processes events returned by epoll_wait.
+	/// Processes events returned by epoll_wait. What each fd is comes from _fds.
 	/// \param events Array of epoll events to process.
 	/// \param event_count Number of events in the array.
 	void processEpollEvents(const struct epoll_event *events, int event_count);
 
-	/// Determines if a file descriptor belongs to a listening socket.
-	/// \param fd The file descriptor to check.
-	/// \returns True if fd is a listening socket, false otherwise.
-	bool isListeningSocket(int fd) const;
-
 	/// Handles epoll events for client connections.
 	/// \param fd The client file descriptor.
 	/// \param event_mask The epoll event mask indicating event types.
 	void handleClientEvent(int fd, uint32_t event_mask);
 
-	/// Handles receiving data from a client connection.
+	/// Handles receiving data from a client connection. In edge-triggered mode
+	/// reads until EAGAIN or until the connection used its IO_BUDGET.
 	/// \param conn The connection to receive data from.
 	void handleClientRecv(Connection *conn);
 
+	/// Serves again the edge-triggered connections that still had data
+	/// to read or write when their budget ran out.
+	void processReadyConnections();
+
 	/// Receives data from client socket with error handling.
 	/// \param client_fd The client socket file descriptor.
 	/// \param buffer Buffer to store received data.
@@ -302,20 +498,100 @@ class WebServer {
 	/// \returns Number of bytes received, or negative value on error.
 	ssize_t receiveData(int client_fd, char *buffer, size_t buffer_size);
 
-	/// Processes received data and determines if request is complete.
-	/// \param conn The connection that received data.
-	/// \param buffer The buffer containing received data.
-	/// \param bytes_read Number of bytes received in this call.
-	/// \param total_bytes_read Total bytes received for this request.
+	/// Answers every complete request in the read_buffer of a connection, in
+	/// order, and waits for the socket to become writable if a response is queued.
+	/// Stops at a request served by a CGI until its output arrives.
+	/// \param conn The connection that received data (or whose CGI finished).
 	/// \returns True if processing succeeded, false on error.
-	bool processReceivedData(Connection *conn, const char *buffer, ssize_t bytes_read);
+	bool processReceivedData(Connection *conn);
+
+	/// Watches a client socket for EPOLLOUT while responses are queued and for
+	/// EPOLLIN otherwise. Does nothing if the registration already matches.
+	/// \param conn The connection.
+	/// \returns True on success, false if epoll_ctl failed.
+	bool updateClientEvents(Connection *conn);
 
 	/* Handlers/MethodsHandler.cpp */
 
+	/* Handlers/CompressedReq.cpp */
+
+	/// Finds the precompressed sibling of a file accepted by the client:
+	/// file.br, then file.gz.
+	/// \param req The request, for Accept-Encoding.
+	/// \param file The requested file.
+	/// \param encoding Set to the content coding of the sibling.
+	/// \returns The sibling, to be released by the caller, or NULL.
+	CachedFile *findPrecompressed(const ClientRequest &req, const CachedFile &file,
+	                              std::string &encoding);
+
+	/// \returns Whether a file is compressed on the fly for a request: gzip on,
+	///          a compressible type, a size from gzip_min_length to GZIP_MAX_SIZE,
+	///          no Range, and gzip accepted by the client.
+	bool shouldGzip(const ClientRequest &req, const CachedFile &file) const;
+
+	/// Compresses a regular file with gzip, reading and deflating it in chunks.
+	/// \param file The file.
+	/// \param out Set to the compressed bytes.
+	/// \returns False if the file could not be read or compressed.
+	bool gzipFile(const CachedFile &file, std::string &out);
+
+	/* Handlers/ConditionalReq.cpp */
+
+	/// ETag sent for a file: its strong validator, or a weak one while the file
+	/// is less than a second old.
+	/// \param file The file.
+	/// \returns The quoted entity-tag, with W/ when weak.
+	static std::string entityTag(const CachedFile &file);
+
+	/// Evaluates If-None-Match, or If-Modified-Since when there is none.
+	/// \param req The request.
+	/// \param file The requested file.
+	/// \param etag Its entity-tag, see entityTag().
+	/// \returns True if the client's copy is current and a 304 answers.
+	bool isNotModified(const ClientRequest &req, const CachedFile &file,
+	                   const std::string &etag) const;
+
+	/// Answers the Range header of a request for a regular file, honouring
+	/// If-Range: 206 with one range or multipart/byteranges, or 416.
+	/// \param req The request.
+	/// \param conn The connection, for the error page of a 416.
+	/// \param file The requested file.
+	/// \param etag Its entity-tag, see entityTag().
+	/// \param resp Set to the response when true is returned.
+	/// \returns False if the whole file is to be sent instead: no Range, a
+	///          stale If-Range, or a Range that is not valid (or asks for too
+	///          many ranges).
+	bool respRangeRequest(const ClientRequest &req, Connection *conn, CachedFile *file,
+	                      const std::string &etag, Response &resp);
+
 	/* Handlers/ResponseHandler.cpp */
 
-	Response respDirectoryRequest(Connection *conn, const std::string &fullDirPath);
-	Response respFileRequest(Connection *conn, const std::string &fullFilePath);
+	Response respDirectoryRequest(const ClientRequest &req, Connection *conn,
+	                              const std::string &fullDirPath);
+
+	/// Serves a static file: 304 when the client's copy is still valid (before
+	/// the file is read at all), 206 or 416 for a Range, 200 otherwise.
+	/// \param req The request, for its conditional and Range headers.
+	/// \param conn The connection, for the location and error pages.
+	/// \param fullFilePath Path of the file.
+	/// \returns The response; the file itself is only sent by the output queue.
+	Response respFileRequest(const ClientRequest &req, Connection *conn,
+	                         const std::string &fullFilePath);
+	/// Looks a path up in the open-file cache, or opens it when the cache is off.
+	/// \param path Path of the file.
+	/// \returns A reference the caller releases, or NULL with errno set.
+	CachedFile *acquireFile(const std::string &path);
+
+	/// Answers a request for a file found with acquireFile(), see respFileRequest().
+	/// \param req The request.
+	/// \param conn The connection.
+	/// \param file The requested file; resp takes its own reference if it sends it.
+	/// \param variant Its precompressed sibling to send instead, or NULL.
+	/// \param encoding Content coding of variant.
+	/// \param resp Set to the response.
+	void serveFile(const ClientRequest &req, Connection *conn, CachedFile *file,
+	               CachedFile *variant, std::string encoding, Response &resp);
+
 	Response respReturnDirective(Connection *conn, uint16_t code, std::string target);
 
 	/// Prepares response data for transmission to client.
@@ -324,9 +600,10 @@ class WebServer {
 	/// \returns Number of bytes prepared for sending, or negative on error.
 	ssize_t prepareResponse(Connection *conn, const Response &resp);
 
-	/// Sends prepared response data to client.
+	/// Sends prepared response data to client. What the socket does not accept
+	/// is kept on the connection and sent on the next EPOLLOUT.
 	/// \param conn The connection to send response to.
-	/// \returns True if response was sent successfully, false otherwise.
+	/// \returns True if no error occurred (even if data is still pending), false otherwise.
 	bool sendResponse(Connection *conn);
 };
 
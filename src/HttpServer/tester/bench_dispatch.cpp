@@ -0,0 +1,125 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_dispatch.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/20 11:15:04 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/20 11:15:04 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Per-event dispatch cost: the old chain (scan of the listeners, then a map
+// lookup in the CGI pool, then one in the connections) against one FdTable load.
+//
+// usage: ./bench_dispatch [connections] [listeners] [events]
+
+#include "src/HttpServer/Structs/FdTable.hpp"
+#include <time.h>
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Deterministic pseudo-random event order, same for both runs
+static std::vector<int> makeEvents(int first_fd, int last_fd, size_t count) {
+	std::vector<int> events(count);
+	uint32_t state = 42;
+	for (size_t i = 0; i < count; ++i) {
+		state = state * 1664525u + 1013904223u;
+		events[i] = first_fd + static_cast<int>(state % (last_fd - first_fd));
+	}
+	return events;
+}
+
+int main(int argc, char **argv) {
+	int connections = argc > 1 ? std::atoi(argv[1]) : 50000;
+	int listeners = argc > 2 ? std::atoi(argv[2]) : 4;
+	size_t event_count = argc > 3 ? std::atoi(argv[3]) : 10000000;
+	int cgis = 64;
+
+	// Fd layout as the kernel would hand it out: listeners, then CGI pipes and clients
+	int first_fd = 3;
+	int first_client = first_fd + listeners + cgis;
+	int last_fd = first_client + connections;
+	std::vector<char> objects(last_fd); // only their addresses are used
+
+	std::vector<int> listener_fds;
+	std::map<int, std::pair<CGI *, Connection *> > cgi_pool;
+	std::map<int, Connection *> conn_map;
+	FdTable table;
+
+	for (int fd = first_fd; fd < last_fd; ++fd) {
+		void *obj = &objects[fd];
+		if (fd < first_fd + listeners) {
+			listener_fds.push_back(fd);
+			table.addListener(fd, static_cast<ServerConfig *>(obj));
+		} else if (fd < first_client) {
+			cgi_pool[fd] = std::make_pair(static_cast<CGI *>(obj), static_cast<Connection *>(obj));
+			table.addCGI(fd, static_cast<CGI *>(obj), static_cast<Connection *>(obj));
+		} else {
+			conn_map[fd] = static_cast<Connection *>(obj);
+			table.addClient(fd, static_cast<Connection *>(obj));
+		}
+	}
+
+	std::vector<int> events = makeEvents(first_fd, last_fd, event_count);
+	uintptr_t sink = 0;
+
+	// Old dispatch: isListeningSocket(), isCGIFd(), then _connections.find()
+	double start = now();
+	for (size_t i = 0; i < events.size(); ++i) {
+		int fd = events[i];
+		bool listener = false;
+		for (size_t l = 0; l < listener_fds.size(); ++l) {
+			if (listener_fds[l] == fd) {
+				listener = true;
+				break;
+			}
+		}
+		if (listener) {
+			sink += fd;
+			continue;
+		}
+		std::map<int, std::pair<CGI *, Connection *> >::iterator cgi = cgi_pool.find(fd);
+		if (cgi != cgi_pool.end()) {
+			sink += reinterpret_cast<uintptr_t>(cgi->second.first);
+			continue;
+		}
+		std::map<int, Connection *>::iterator conn = conn_map.find(fd);
+		if (conn != conn_map.end())
+			sink += reinterpret_cast<uintptr_t>(conn->second);
+	}
+	double legacy = now() - start;
+
+	// New dispatch: one slot load and a switch on its kind
+	start = now();
+	for (size_t i = 0; i < events.size(); ++i) {
+		const FdTable::Slot &slot = table[events[i]];
+		switch (slot.kind) {
+		case FdTable::LISTENER:
+			sink += events[i];
+			break;
+		case FdTable::CGI_OUTPUT:
+			sink += reinterpret_cast<uintptr_t>(slot.cgi);
+			break;
+		case FdTable::CLIENT:
+			sink += reinterpret_cast<uintptr_t>(slot.conn);
+			break;
+		default:
+			break;
+		}
+	}
+	double table_time = now() - start;
+
+	std::cout << connections << " connections, " << listeners << " listeners, " << cgis
+	          << " CGI pipes, " << events.size() << " events" << std::endl;
+	std::cout << "scan + maps : " << legacy * 1e9 / events.size() << " ns/event" << std::endl;
+	std::cout << "FdTable     : " << table_time * 1e9 / events.size() << " ns/event" << std::endl;
+	std::cout << "speedup     : " << legacy / table_time << "x (checksum " << (sink & 0xff) << ")"
+	          << std::endl;
+	return 0;
+}
@@ -0,0 +1,109 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_locations.cpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/01 10:02:40 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/01 10:02:40 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Cost of routing a URI to its location: the old linear scan of the paths
+// sorted longest first, with a substr per candidate, against LocationTrie.
+// Both must agree on every URI, which is checked before timing.
+//
+// usage: ./bench_locations [locations] [lookups]
+
+#include "includes/Webserv.hpp"
+#include "src/ConfigParser/LocationTrie.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static bool longerFirst(const std::string &a, const std::string &b) {
+	if (a.length() != b.length())
+		return a.length() > b.length();
+	return a < b;
+}
+
+static bool isPrefixMatch(const std::string &uri, const std::string &path, bool &exact) {
+	if (path.empty() || path == "/") {
+		exact = uri == "/";
+		return true;
+	}
+	if (uri.length() < path.length() || uri.substr(0, path.length()) != path)
+		return false;
+	exact = uri.length() == path.length();
+	return exact || uri[path.length()] == '/' || path[path.length() - 1] == '/';
+}
+
+static int linearMatch(const std::string &uri, const std::vector<std::string> &paths,
+                       bool &exact) {
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (isPrefixMatch(uri, paths[i], exact))
+			return static_cast<int>(i);
+	}
+	return -1;
+}
+
+int main(int argc, char **argv) {
+	size_t count = argc > 1 ? std::atoi(argv[1]) : 300;
+	size_t lookups = argc > 2 ? std::atoi(argv[2]) : 1000000;
+	static const char *sections[] = {"/api/", "/static/", "/img", "/docs/v", "/user/"};
+
+	std::vector<std::string> paths;
+	paths.push_back("/");
+	for (size_t i = 0; paths.size() < count; ++i)
+		paths.push_back(sections[i % 5] + su::to_string(i / 5) + (i % 3 ? "/" : ""));
+	std::sort(paths.begin(), paths.end(), longerFirst);
+	LocationTrie trie;
+	trie.build(paths);
+
+	std::vector<std::string> uris;
+	for (size_t i = 0; i < 1000; ++i) {
+		std::string base = paths[(i * 7919) % paths.size()];
+		if (i % 4 == 0)
+			uris.push_back(base);
+		else if (i % 4 == 1)
+			uris.push_back(base + (su::back(base) == '/' ? "" : "/") + "index.html");
+		else if (i % 4 == 2)
+			uris.push_back(base + "x/file.css");
+		else
+			uris.push_back("/nowhere/" + su::to_string(i));
+	}
+
+	for (size_t i = 0; i < uris.size(); ++i) {
+		bool exact_linear = false;
+		bool exact_trie = false;
+		int linear = linearMatch(uris[i], paths, exact_linear);
+		int found = trie.find(uris[i], exact_trie);
+		if (linear != found || exact_linear != exact_trie) {
+			std::cerr << "mismatch on " << uris[i] << ": " << linear << " vs " << found
+			          << std::endl;
+			return 1;
+		}
+	}
+	std::cout << paths.size() << " locations, " << lookups << " lookups" << std::endl;
+
+	bool exact;
+	size_t sum = 0;
+	double start = now();
+	for (size_t i = 0; i < lookups; ++i)
+		sum += linearMatch(uris[i % uris.size()], paths, exact);
+	double linear = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < lookups; ++i)
+		sum += trie.find(uris[i % uris.size()], exact);
+	double trie_time = now() - start;
+
+	std::cout << "linear scan : " << linear * 1e9 / lookups << " ns/lookup" << std::endl;
+	std::cout << "trie        : " << trie_time * 1e9 / lookups << " ns/lookup" << std::endl;
+	return sum == 0; // keeps the loops from being optimized out
+}
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_response.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/31 10:20:03 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/31 10:20:03 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Cost of serializing the head of a typical static file response: the old way
+// (headers in a std::map, an ostringstream, numbers and the date formatted per
+// response, a new string each time) against ResponseWriter (status line from
+// the table, headers in insertion order, the Date line of the current second,
+// one reused buffer).
+//
+// usage: ./bench_response [responses]
+
+#include "includes/Webserv.hpp"
+#include "src/HttpServer/Structs/ResponseWriter.hpp"
+#include "src/Utils/GeneralUtils.hpp"
+#include "src/Utils/StringUtils.hpp"
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static std::string reasonSwitch(uint16_t code) {
+	switch (code) {
+	case 200:
+		return "OK";
+	case 304:
+		return "Not Modified";
+	case 404:
+		return "Not Found";
+	default:
+		return "Unknown";
+	}
+}
+
+static size_t serializeOld(uint16_t code, size_t length) {
+	std::map<std::string, std::string> headers;
+	headers["Date"] = httpDate(time(NULL));
+	headers["Content-Type"] = "text/html";
+	headers["ETag"] = "\"ce802f-19-6ad40967\"";
+	headers["Last-Modified"] = "Sat, 17 Oct 2026 23:48:55 GMT";
+	headers["Accept-Ranges"] = "bytes";
+	headers["Content-Length"] = su::to_string(length);
+
+	std::ostringstream stream;
+	stream << "HTTP/1.1" << " " << code << " " << reasonSwitch(code) << "\r\n";
+	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
+	     it != headers.end(); ++it)
+		stream << it->first << ": " << it->second << "\r\n";
+	stream << "\r\n";
+	return stream.str().size();
+}
+
+typedef std::vector<std::pair<std::string, std::string> > HeaderList;
+
+static size_t serializeNew(uint16_t code, size_t length, DateHeader &date, HeaderList &headers,
+                           std::string &out) {
+	headers.clear();
+	headers.push_back(std::make_pair("Content-Type", "text/html"));
+	headers.push_back(std::make_pair("ETag", "\"ce802f-19-6ad40967\""));
+	headers.push_back(std::make_pair("Last-Modified", "Sat, 17 Oct 2026 23:48:55 GMT"));
+	headers.push_back(std::make_pair("Accept-Ranges", "bytes"));
+	headers.push_back(std::make_pair("Content-Length", ResponseWriter::numberToString(length)));
+
+	out.clear();
+	ResponseWriter::appendStatusLine(out, code);
+	out += date.line();
+	for (HeaderList::const_iterator it = headers.begin(); it != headers.end(); ++it)
+		ResponseWriter::appendHeader(out, it->first, it->second);
+	out.append("\r\n", 2);
+	return out.size();
+}
+
+static void report(const char *name, double elapsed, size_t responses, size_t bytes) {
+	std::cout << name << elapsed * 1e9 / responses << " ns/response (" << bytes / responses
+	          << " bytes)" << std::endl;
+}
+
+int main(int argc, char **argv) {
+	size_t responses = argc > 1 ? std::atoi(argv[1]) : 2000000;
+	static const uint16_t codes[] = {200, 200, 200, 304};
+
+	size_t bytes = 0;
+	double start = now();
+	for (size_t i = 0; i < responses; ++i)
+		bytes += serializeOld(codes[i % 4], 1000 + i % 5000);
+	report("map + ostringstream : ", now() - start, responses, bytes);
+
+	DateHeader date;
+	HeaderList headers;
+	std::string out;
+	bytes = 0;
+	start = now();
+	for (size_t i = 0; i < responses; ++i)
+		bytes += serializeNew(codes[i % 4], 1000 + i % 5000, date, headers, out);
+	report("ResponseWriter      : ", now() - start, responses, bytes);
+	return 0;
+}
@@ -0,0 +1,183 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_static.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/28 10:05:51 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/28 10:05:51 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Cost of sending a static file to a socket, per strategy: read into a string
+// (the old getFileContent), mmap per request, one shared mmap, sendfile. Every
+// regular file of a tree is sent in turn to a socketpair drained by a child.
+//
+// usage: ./bench_static [tree] [rounds]
+
+#include "includes/Webserv.hpp"
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void listFiles(const std::string &dir, std::vector<std::string> &files) {
+	DIR *d = opendir(dir.c_str());
+	if (!d)
+		return;
+	struct dirent *entry;
+	while ((entry = readdir(d)) != NULL) {
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		std::string path = dir + "/" + name;
+		struct stat st;
+		if (stat(path.c_str(), &st) == -1)
+			continue;
+		if (S_ISDIR(st.st_mode))
+			listFiles(path, files);
+		else if (S_ISREG(st.st_mode))
+			files.push_back(path);
+	}
+	closedir(d);
+}
+
+static bool sendAll(int sock, const char *data, size_t size) {
+	while (size > 0) {
+		ssize_t sent = send(sock, data, size, MSG_NOSIGNAL);
+		if (sent <= 0)
+			return false;
+		data += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+static size_t sendString(int sock, const std::string &path) {
+	std::ifstream file(path.c_str(), std::ios::in | std::ios::binary);
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	std::string content = buffer.str();
+	sendAll(sock, content.data(), content.size());
+	return content.size();
+}
+
+static size_t sendMapped(int sock, const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat st;
+	fstat(fd, &st);
+	size_t size = st.st_size;
+	if (size > 0) {
+		void *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+		madvise(map, size, MADV_SEQUENTIAL);
+		madvise(map, size, MADV_WILLNEED);
+		sendAll(sock, static_cast<const char *>(map), size);
+		munmap(map, size);
+	}
+	close(fd);
+	return size;
+}
+
+static size_t sendFile(int sock, const std::string &path) {
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	struct stat st;
+	fstat(fd, &st);
+	off_t offset = 0;
+	while (offset < st.st_size) {
+		if (sendfile(sock, fd, &offset, st.st_size - offset) <= 0)
+			break;
+	}
+	close(fd);
+	return st.st_size;
+}
+
+struct Mapping {
+	const char *data;
+	size_t size;
+};
+
+static void report(const char *name, double elapsed, size_t requests, size_t bytes) {
+	std::cout << name << elapsed * 1e6 / requests << " us/request, "
+	          << bytes / elapsed / (1024 * 1024) << " MiB/s" << std::endl;
+}
+
+int main(int argc, char **argv) {
+	std::string tree = argc > 1 ? argv[1] : "../../../helene";
+	size_t rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+	std::vector<std::string> files;
+	listFiles(tree, files);
+	if (files.empty()) {
+		std::cerr << "no files under " << tree << std::endl;
+		return 1;
+	}
+
+	int socks[2];
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, socks) == -1)
+		return 1;
+	pid_t drain = fork();
+	if (drain == 0) {
+		close(socks[0]);
+		char buf[65536];
+		while (read(socks[1], buf, sizeof(buf)) > 0)
+			;
+		_exit(0);
+	}
+	close(socks[1]);
+	int sock = socks[0];
+	size_t requests = rounds * files.size();
+	size_t bytes = 0;
+
+	// Shared mappings, made once as the server does for a hot file
+	std::vector<Mapping> maps(files.size());
+	for (size_t i = 0; i < files.size(); ++i) {
+		int fd = open(files[i].c_str(), O_RDONLY | O_CLOEXEC);
+		struct stat st;
+		fstat(fd, &st);
+		maps[i].size = st.st_size;
+		maps[i].data = NULL;
+		if (st.st_size > 0) {
+			void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			madvise(map, st.st_size, MADV_WILLNEED);
+			maps[i].data = static_cast<const char *>(map);
+		}
+		close(fd);
+		bytes += st.st_size;
+	}
+	bytes *= rounds;
+
+	std::cout << files.size() << " files under " << tree << ", " << rounds << " rounds, "
+	          << bytes / rounds << " bytes per round" << std::endl;
+
+	double start = now();
+	for (size_t r = 0; r < rounds; ++r)
+		for (size_t i = 0; i < files.size(); ++i)
+			sendString(sock, files[i]);
+	report("read into string : ", now() - start, requests, bytes);
+
+	start = now();
+	for (size_t r = 0; r < rounds; ++r)
+		for (size_t i = 0; i < files.size(); ++i)
+			sendMapped(sock, files[i]);
+	report("mmap per request : ", now() - start, requests, bytes);
+
+	start = now();
+	for (size_t r = 0; r < rounds; ++r)
+		for (size_t i = 0; i < files.size(); ++i)
+			if (maps[i].data)
+				sendAll(sock, maps[i].data, maps[i].size);
+	report("shared mmap      : ", now() - start, requests, bytes);
+
+	start = now();
+	for (size_t r = 0; r < rounds; ++r)
+		for (size_t i = 0; i < files.size(); ++i)
+			sendFile(sock, files[i]);
+	report("sendfile         : ", now() - start, requests, bytes);
+
+	close(sock);
+	waitpid(drain, NULL, 0);
+	return 0;
+}
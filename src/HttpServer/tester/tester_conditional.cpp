@@ -0,0 +1,158 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   tester_conditional.cpp                             :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/29 09:41:17 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/29 09:41:17 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Range, If-Range and If-None-Match parsing against expected results.
+//
+// usage: ./tester_conditional (exits with 1 if a case fails)
+
+#include "src/HttpServer/Structs/Conditional.hpp"
+#include "src/Utils/GeneralUtils.hpp"
+
+// "ignored" when the header is not a valid range set (the whole file is sent),
+// "416" when no range overlaps the file, else the clamped ranges
+struct RangeCase {
+	const char *name;
+	const char *header;
+	off_t size;
+	const char *expected;
+};
+
+static const RangeCase range_cases[] = {
+    {"single range", "bytes=0-9", 100, "0-9"},
+    {"open-ended range", "bytes=90-", 100, "90-99"},
+    {"last beyond EOF is clamped", "bytes=50-1000", 100, "50-99"},
+    {"suffix range", "bytes=-10", 100, "90-99"},
+    {"suffix larger than the file", "bytes=-500", 100, "0-99"},
+    {"suffix of zero bytes", "bytes=-0", 100, "416"},
+    {"first at EOF", "bytes=100-", 100, "416"},
+    {"first beyond EOF", "bytes=200-300", 100, "416"},
+    {"only the satisfiable ones are kept", "bytes=200-300, 0-0", 100, "0-0"},
+    {"several ranges, in request order", "bytes=50-59, 0-9", 100, "50-59,0-9"},
+    {"empty file", "bytes=0-", 0, "416"},
+    {"empty list elements", "bytes=, 0-1,, ,2-3,", 100, "0-1,2-3"},
+    {"only empty elements", "bytes=, ,", 100, "ignored"},
+    {"spaces around elements", "bytes= 1-2 ,\t3-4", 100, "1-2,3-4"},
+    {"unit is case insensitive", "Bytes=0-0", 100, "0-0"},
+    {"other unit", "items=0-9", 100, "ignored"},
+    {"no unit", "0-9", 100, "ignored"},
+    {"no dash", "bytes=10", 100, "ignored"},
+    {"last before first", "bytes=9-0", 100, "ignored"},
+    {"negative first", "bytes=--5", 100, "ignored"},
+    {"not a number", "bytes=a-b", 100, "ignored"},
+    {"one bad element spoils the set", "bytes=0-9, x", 100, "ignored"},
+    {"16 ranges",
+     "bytes=0-0,1-1,2-2,3-3,4-4,5-5,6-6,7-7,8-8,9-9,10-10,11-11,12-12,13-13,14-14,15-15", 100,
+     "0-0,1-1,2-2,3-3,4-4,5-5,6-6,7-7,8-8,9-9,10-10,11-11,12-12,13-13,14-14,15-15"},
+    {"17 ranges",
+     "bytes=0-0,1-1,2-2,3-3,4-4,5-5,6-6,7-7,8-8,9-9,10-10,11-11,12-12,13-13,14-14,15-15,16-16", 100,
+     "ignored"},
+    {"largest offset", "bytes=9223372036854775807-", 100, "416"},
+    {"overflowing first", "bytes=9223372036854775808-", 100, "ignored"},
+    {"overflowing last", "bytes=0-99999999999999999999", 100, "ignored"},
+    {"overflowing suffix", "bytes=-99999999999999999999", 100, "ignored"},
+};
+
+struct MatchCase {
+	const char *name;
+	const char *list;
+	const char *etag;
+	bool expected;
+};
+
+static const MatchCase match_cases[] = {
+    {"same tag", "\"abc\"", "\"abc\"", true},
+    {"other tag", "\"abc\"", "\"abd\"", false},
+    {"weak in the list", "W/\"abc\"", "\"abc\"", true},
+    {"weak current tag", "\"abc\"", "W/\"abc\"", true},
+    {"one of a list", "\"x\", W/\"y\" ,\"abc\"", "\"abc\"", true},
+    {"none of a list", "\"x\", \"y\"", "\"abc\"", false},
+    {"star", "*", "\"abc\"", true},
+    {"star after a tag", "\"x\", *", "\"abc\"", true},
+    {"unquoted tag", "abc", "\"abc\"", false},
+    {"unterminated tag", "\"abc", "\"abc\"", false},
+    {"empty list", "", "\"abc\"", false},
+    {"prefix of the tag", "\"ab\"", "\"abc\"", false},
+};
+
+struct IfRangeCase {
+	const char *name;
+	std::string if_range;
+	const char *etag;
+	time_t mtime;
+	bool expected;
+};
+
+static std::string formatRanges(bool valid, const std::vector<Conditional::ByteRange> &ranges) {
+	if (!valid)
+		return "ignored";
+	if (ranges.empty())
+		return "416";
+	std::ostringstream oss;
+	for (size_t i = 0; i < ranges.size(); ++i)
+		oss << (i ? "," : "") << ranges[i].first << "-" << ranges[i].last;
+	return oss.str();
+}
+
+static int cases = 0;
+static int failures = 0;
+
+static void report(const std::string &name, bool ok, const std::string &got,
+                   const std::string &expected) {
+	++cases;
+	std::cout << "=== Test: " << name << " ===" << std::endl;
+	if (!ok) {
+		std::cout << "got: " << got << ", expected: " << expected << std::endl;
+		++failures;
+	}
+	std::cout << "Result: " << (ok ? "PASS ✅" : "FAIL ❌") << std::endl;
+}
+
+int main(void) {
+	for (size_t i = 0; i < sizeof(range_cases) / sizeof(range_cases[0]); ++i) {
+		const RangeCase &c = range_cases[i];
+		std::vector<Conditional::ByteRange> ranges;
+		bool valid = Conditional::parseRanges(c.header, c.size, ranges);
+		std::string got = formatRanges(valid, ranges);
+		report(std::string("Range ") + c.name, got == c.expected, got, c.expected);
+	}
+
+	for (size_t i = 0; i < sizeof(match_cases) / sizeof(match_cases[0]); ++i) {
+		const MatchCase &c = match_cases[i];
+		bool got = Conditional::matchesAny(c.list, c.etag);
+		report(std::string("If-None-Match ") + c.name, got == c.expected,
+		       got ? "match" : "no match", c.expected ? "match" : "no match");
+	}
+
+	time_t mtime = 784111777; // Sun, 06 Nov 1994 08:49:37 GMT
+	const IfRangeCase if_range_cases[] = {
+	    {"same strong tag", "\"abc\"", "\"abc\"", mtime, true},
+	    {"other strong tag", "\"abd\"", "\"abc\"", mtime, false},
+	    {"weak tag in If-Range", "W/\"abc\"", "\"abc\"", mtime, false},
+	    {"weak current tag", "\"abc\"", "W/\"abc\"", mtime, false},
+	    {"same weak tags", "W/\"abc\"", "W/\"abc\"", mtime, false},
+	    {"exact date", httpDate(mtime), "\"abc\"", mtime, true},
+	    {"older date", httpDate(mtime - 1), "\"abc\"", mtime, false},
+	    {"newer date", httpDate(mtime + 1), "\"abc\"", mtime, false},
+	    {"date with a weak current tag", httpDate(mtime), "W/\"abc\"", mtime, false},
+	    {"invalid date", "yesterday", "\"abc\"", mtime, false},
+	    {"empty", "", "\"abc\"", mtime, false},
+	};
+	for (size_t i = 0; i < sizeof(if_range_cases) / sizeof(if_range_cases[0]); ++i) {
+		const IfRangeCase &c = if_range_cases[i];
+		bool got = Conditional::ifRangeMatches(c.if_range, c.etag, c.mtime);
+		report(std::string("If-Range ") + c.name, got == c.expected, got ? "range" : "full file",
+		       c.expected ? "range" : "full file");
+	}
+
+	std::cout << std::endl << cases - failures << "/" << cases << " passed" << std::endl;
+	return failures ? 1 : 0;
+}
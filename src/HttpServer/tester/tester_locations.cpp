@@ -0,0 +1,169 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   tester_locations.cpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/02 10:04:51 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/02 10:04:51 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Location routing of LocationTrie against expected results, and against the
+// linear matcher it replaced (paths sorted longest first, the first prefix
+// match wins). Every case is run with the paths inserted in several orders,
+// so that edge splits happen in different places.
+//
+// usage: ./tester_locations (exits with 1 if a case fails)
+
+#include "includes/Webserv.hpp"
+#include "src/ConfigParser/LocationTrie.hpp"
+
+// The old rules: "/" matches anything; a path matches the whole URI, a URI
+// that continues with '/', or any URI when it ends with '/' itself
+static bool isPrefixMatch(const std::string &uri, const std::string &path, bool &exact) {
+	if (path.empty() || path == "/") {
+		exact = uri == "/";
+		return true;
+	}
+	if (uri.length() < path.length() || uri.substr(0, path.length()) != path)
+		return false;
+	exact = uri.length() == path.length();
+	return exact || uri[path.length()] == '/' || path[path.length() - 1] == '/';
+}
+
+static bool longerFirst(const std::string &a, const std::string &b) {
+	if (a.length() != b.length())
+		return a.length() > b.length();
+	return a < b;
+}
+
+static std::string linearMatch(const std::string &uri, std::vector<std::string> paths,
+                               bool &exact) {
+	std::sort(paths.begin(), paths.end(), longerFirst);
+	for (size_t i = 0; i < paths.size(); ++i) {
+		if (isPrefixMatch(uri, paths[i], exact))
+			return paths[i];
+	}
+	exact = false;
+	return "none";
+}
+
+// Expected location path ("none" if no location matches) and exact flag
+struct LocationCase {
+	const char *uri;
+	const char *expected;
+	bool exact;
+};
+
+static const char *with_root[] = {"/",     "/img",    "/images", "/img/a",
+                                  "/api/", "/api/v1", "/docs/",  0};
+
+static const LocationCase with_root_cases[] = {
+    {"/", "/", true},
+    {"/nowhere", "/", false},
+    {"/img", "/img", true},
+    {"/img/", "/img", false},
+    {"/img/x.png", "/img", false},
+    {"/img/a", "/img/a", true},
+    {"/img/a/b.png", "/img/a", false},
+    {"/img/ab", "/img", false},         // "/img/a" stops inside a segment
+    {"/images", "/images", true},
+    {"/images/1.png", "/images", false},
+    {"/imgs", "/", false},              // "/img" stops inside a segment
+    {"/imag", "/", false},              // the URI is a prefix of "/images"
+    {"/im", "/", false},
+    {"/api/", "/api/", true},
+    {"/api", "/", false},               // shorter than "/api/"
+    {"/api/x", "/api/", false},
+    {"/api/v1", "/api/v1", true},
+    {"/api/v1/users", "/api/v1", false},
+    {"/api/v12", "/api/", false},       // falls back to the location ending with '/'
+    {"/docs/guide/intro", "/docs/", false},
+    {"/docs", "/", false},
+};
+
+// No default location, and paths sharing prefixes so that edges are split
+static const char *without_root[] = {"/abc/", "/ab", "/a", "/b/c", "/b/cd", "/bc", 0};
+
+static const LocationCase without_root_cases[] = {
+    {"/", "none", false},
+    {"/x", "none", false},
+    {"/a", "/a", true},
+    {"/a/b", "/a", false},
+    {"/ab", "/ab", true},
+    {"/ab/c", "/ab", false},
+    {"/abc", "none", false},            // neither "/ab" nor "/a" ends a segment there
+    {"/abc/", "/abc/", true},
+    {"/abc/d", "/abc/", false},
+    {"/abcd", "none", false},
+    {"/b", "none", false},
+    {"/b/c", "/b/c", true},
+    {"/b/c/x", "/b/c", false},
+    {"/b/cd", "/b/cd", true},
+    {"/b/ce", "none", false},
+    {"/bc", "/bc", true},
+    {"/bcd", "none", false},
+};
+
+static int cases = 0;
+static int failures = 0;
+
+static void report(const std::string &name, bool ok, const std::string &got,
+                   const std::string &expected) {
+	++cases;
+	std::cout << "=== Test: " << name << " ===" << std::endl;
+	if (!ok) {
+		std::cout << "got: " << got << ", expected: " << expected << std::endl;
+		++failures;
+	}
+	std::cout << "Result: " << (ok ? "PASS ✅" : "FAIL ❌") << std::endl;
+}
+
+static std::string describe(const std::string &path, bool exact) {
+	return path + (exact ? " (exact)" : "");
+}
+
+static void runCases(const char *set, const char **locations, const LocationCase *table,
+                     size_t count) {
+	std::vector<std::string> paths;
+	for (size_t i = 0; locations[i]; ++i)
+		paths.push_back(locations[i]);
+
+	// As written, reversed and sorted longest first (what the config parser does)
+	std::vector<std::vector<std::string> > orders(3, paths);
+	std::reverse(orders[1].begin(), orders[1].end());
+	std::sort(orders[2].begin(), orders[2].end(), longerFirst);
+	static const char *order_names[] = {"as written", "reversed", "longest first"};
+
+	for (size_t o = 0; o < orders.size(); ++o) {
+		LocationTrie trie;
+		trie.build(orders[o]);
+		for (size_t i = 0; i < count; ++i) {
+			const LocationCase &c = table[i];
+			bool exact = false;
+			int index = trie.find(c.uri, exact);
+			std::string got = describe(index < 0 ? "none" : orders[o][index], exact);
+			std::string expected = describe(c.expected, c.exact);
+			report(std::string(set) + " " + order_names[o] + " " + c.uri, got == expected, got,
+			       expected);
+
+			bool old_exact = false;
+			std::string old = linearMatch(c.uri, paths, old_exact);
+			old = describe(old, old_exact);
+			report(std::string(set) + " " + order_names[o] + " " + c.uri + " (old rules)",
+			       got == old, got, old);
+		}
+	}
+}
+
+int main(void) {
+	runCases("root", with_root, with_root_cases,
+	         sizeof(with_root_cases) / sizeof(with_root_cases[0]));
+	runCases("no root", without_root, without_root_cases,
+	         sizeof(without_root_cases) / sizeof(without_root_cases[0]));
+
+	std::cout << std::endl << cases - failures << "/" << cases << " passed" << std::endl;
+	return failures ? 1 : 0;
+}
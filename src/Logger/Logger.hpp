@@ -25,6 +25,7 @@ class Logger {
 	      fileOutput(false),
 	      logFileName(filename) {
 
+		pthread_mutex_init(&outputLock, NULL);
 		if (!filename.empty()) {
 			logFile.open(filename.c_str(), std::ios::app);
 			if (logFile.is_open()) {
@@ -39,6 +40,7 @@ class Logger {
 		if (logFile.is_open()) {
 			logFile.close();
 		}
+		pthread_mutex_destroy(&outputLock);
 	}
 
 	// Set minimum log level
@@ -58,6 +60,9 @@ class Logger {
 
 		std::string formattedMessage = formatMessage(level, message);
 
+		// Some loggers (e.g. the Response one) are shared between event-loop threads
+		pthread_mutex_lock(&outputLock);
+
 		// Output to console
 		if (consoleOutput) {
 			if (level >= ERROR) {
@@ -72,6 +77,7 @@ class Logger {
 			logFile << formattedMessage << std::endl;
 			logFile.flush(); // Ensure immediate write
 		}
+		pthread_mutex_unlock(&outputLock);
 	}
 
 	// Convenience methods for different log levels
@@ -104,17 +110,21 @@ class Logger {
 	bool consoleOutput;
 	bool fileOutput;
 	std::string logFileName;
+	pthread_mutex_t outputLock;
+
+	Logger(const Logger &);
+	Logger &operator=(const Logger &);
 
 	// Get current timestamp as string
 	std::string getCurrentTime() const {
 		time_t rawtime;
-		struct tm *timeinfo;
+		struct tm timeinfo;
 		char buffer[80];
 
 		time(&rawtime);
-		timeinfo = localtime(&rawtime);
+		localtime_r(&rawtime, &timeinfo);
 
-		strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", timeinfo);
+		strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &timeinfo);
 		return std::string(buffer);
 	}
 
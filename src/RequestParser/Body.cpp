@@ -12,27 +12,30 @@
 
 #include "RequestParser.hpp"
 
-bool RequestParsingUtils::checkNTrimLine(std::string &line) {
-	Logger logger;
-	// Check line ending (\r\n)
-	if (line.empty()) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid line ending");
-		return (false);
-	}
-	if (!line.empty() && line[line.length() - 1] != '\r') {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid line ending");
+// Content-Length is 1*DIGIT, without sign or spaces
+static bool parseContentLength(const char *value, size_t &length) {
+	if (*value == '\0')
 		return (false);
+	length = 0;
+	for (; *value; ++value) {
+		if (*value < '0' || *value > '9' || length > (SIZE_MAX - 9) / 10)
+			return (false);
+		length = length * 10 + (*value - '0');
 	}
-	if (!line.empty() && line[line.length() - 1] == '\r')
-		line.erase(line.length() - 1);
 	return (true);
 }
 
-bool RequestParsingUtils::parseBody(std::istringstream &stream, ClientRequest &request) {
+// The bytes themselves are kept by the caller (see RequestBody): only their
+// number is checked against the headers
+bool RequestParsingUtils::parseBody(size_t size, ClientRequest &request) {
 	Logger logger;
 	logger.logWithPrefix(Logger::DEBUG, "HTTP", "Parsing message body");
 
-	const char *content_length_value = findHeader(request, "content-length");
+	const std::string *content_length_value = request.headers.get(RequestHeaders::CONTENT_LENGTH);
+
+	// A chunked body is as long as its chunks, decoded by the connection
+	if (request.chunked_encoding)
+		return (true);
 
 	// Enforce Content-Length for POST even if body is empty
 	if (!content_length_value) {
@@ -40,37 +43,26 @@ bool RequestParsingUtils::parseBody(std::istringstream &stream, ClientRequest &r
 			logger.logWithPrefix(Logger::WARNING, "HTTP", "Missing Content-Length for POST");
 			return (false);
 		}
-
 		// For GET/DELETE: accept if no body follows
-		std::streampos start = stream.tellg();
-		char probe;
-		if (stream.get(probe)) {
+		if (size > 0) {
 			logger.logWithPrefix(Logger::WARNING, "HTTP", "Request has body but no Content-Length");
 			return (false);
 		}
-		// Rewind and accept
-		stream.clear();
-		stream.seekg(start);
 		return (true);
 	}
 
 	// Validate and parse Content-Length
-	std::istringstream content_length_stream(content_length_value);
-	int content_length;
-	if (!(content_length_stream >> content_length) || content_length < 0) {
+	size_t content_length;
+	if (!parseContentLength(content_length_value->c_str(), content_length)) {
 		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid Content-Length");
 		return (false);
 	}
-	// Read exactly content_length bytes
-	std::string body(content_length, '\0');
-	stream.read(&body[0], content_length);
-	std::streamsize actually_read = stream.gcount();
-	if (actually_read != content_length) {
+	// Exactly content_length bytes
+	if (size < content_length) {
 		logger.logWithPrefix(Logger::WARNING, "HTTP",
 		                     "Body length mismatch: expected " + su::to_string(content_length) +
-		                         " bytes, but read " + su::to_string(actually_read) + " bytes");
+		                         " bytes, but read " + su::to_string(size) + " bytes");
 		return (false);
 	}
-	request.body = body;
 	return (true);
 }
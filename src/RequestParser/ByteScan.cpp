@@ -0,0 +1,333 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ByteScan.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/03 09:41:18 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/03 09:41:18 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "ByteScan.hpp"
+
+#if defined(__GNUC__) && defined(__x86_64__) // where SSE2 is always there
+#define BYTE_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+const unsigned char ByteScan::token_chars[256] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 1, 0, 1, 1, 1, 1, 1, 0, 0, 1, 1, 0, 1, 1, 0,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 1, 0, 1, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+};
+
+using ByteScan::isToken;
+
+static inline unsigned char byteAt(const char *buf, size_t i) {
+	return static_cast<unsigned char>(buf[i]);
+}
+
+// The classes of the run functions, byte by byte
+static inline bool isUriRunChar(unsigned char c) { return ByteScan::isUriChar(c) && c != '%'; }
+static inline bool isValueRunChar(unsigned char c) { return c >= 0x20 && c != 0x7F; }
+
+/* Scalar */
+
+static size_t scalarFindCRLF(const char *buf, size_t size, size_t i) {
+	for (; i + 1 < size; ++i) {
+		if (buf[i] == '\r' && buf[i + 1] == '\n')
+			return i;
+	}
+	return size;
+}
+
+static size_t scalarTokenRun(const char *buf, size_t size, size_t i) {
+	while (i < size && isToken(byteAt(buf, i)))
+		++i;
+	return i;
+}
+
+static size_t scalarUriRun(const char *buf, size_t size, size_t i) {
+	while (i < size && isUriRunChar(byteAt(buf, i)))
+		++i;
+	return i;
+}
+
+static size_t scalarValueRun(const char *buf, size_t size, size_t i) {
+	while (i < size && isValueRunChar(byteAt(buf, i)))
+		++i;
+	return i;
+}
+
+static size_t scalarFindCRLF(const char *buf, size_t size) { return scalarFindCRLF(buf, size, 0); }
+static size_t scalarTokenRun(const char *buf, size_t size) { return scalarTokenRun(buf, size, 0); }
+static size_t scalarUriRun(const char *buf, size_t size) { return scalarUriRun(buf, size, 0); }
+static size_t scalarValueRun(const char *buf, size_t size) { return scalarValueRun(buf, size, 0); }
+
+#ifdef BYTE_SCAN_X86
+
+// The vector kernels build a mask of the bytes that end the run, and return at
+// its lowest set bit. Unsigned comparisons are done with min/max: x <= n
+// exactly when max(x, n) == n.
+//
+// Token runs are checked against the common case only (letters, digits and
+// '-'); a byte outside it that is still a tchar, like '_', is stepped over by
+// tokenRun() itself.
+
+/* SSE2 */
+
+// Also the tail of the AVX2 kernels: inlined there, they are compiled as AVX
+// instructions. Calling legacy SSE code with the upper halves of the ymm
+// registers in use costs a state transition on every call.
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+static ALWAYS_INLINE __m128i sse2AtMost(__m128i v, char n) {
+	__m128i limit = _mm_set1_epi8(n);
+	return _mm_cmpeq_epi8(_mm_max_epu8(v, limit), limit);
+}
+
+static ALWAYS_INLINE __m128i sse2InRange(__m128i v, char low, char high) {
+	return sse2AtMost(_mm_sub_epi8(v, _mm_set1_epi8(low)), static_cast<char>(high - low));
+}
+
+static ALWAYS_INLINE size_t sse2FindCRLFFrom(const char *buf, size_t size, size_t i) {
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i lf = _mm_set1_epi8('\n');
+	for (; i + 17 <= size; i += 16) {
+		__m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i));
+		__m128i next = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i + 1));
+		int mask = _mm_movemask_epi8(
+		    _mm_and_si128(_mm_cmpeq_epi8(first, cr), _mm_cmpeq_epi8(next, lf)));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return scalarFindCRLF(buf, size, i);
+}
+
+static ALWAYS_INLINE size_t sse2TokenRunFrom(const char *buf, size_t size, size_t i) {
+	for (;;) {
+		for (; i + 16 <= size; i += 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i));
+			__m128i ok = _mm_or_si128(sse2InRange(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z'),
+			                          sse2InRange(v, '0', '9'));
+			ok = _mm_or_si128(ok, _mm_cmpeq_epi8(v, _mm_set1_epi8('-')));
+			int mask = ~_mm_movemask_epi8(ok) & 0xFFFF;
+			if (mask) {
+				i += __builtin_ctz(mask);
+				break;
+			}
+		}
+		if (i + 16 > size)
+			return scalarTokenRun(buf, size, i);
+		if (!isToken(byteAt(buf, i)))
+			return i;
+		++i;
+	}
+}
+
+static ALWAYS_INLINE size_t sse2UriRunFrom(const char *buf, size_t size, size_t i) {
+	for (; i + 16 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i));
+		// Outside 0x21-0x7E, or one of the four bytes that need attention
+		__m128i stop = _mm_xor_si128(sse2InRange(v, 0x21, 0x7E), _mm_set1_epi8(-1));
+		stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('%')));
+		stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+		stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('\'')));
+		stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+		int mask = _mm_movemask_epi8(stop);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return scalarUriRun(buf, size, i);
+}
+
+static ALWAYS_INLINE size_t sse2ValueRunFrom(const char *buf, size_t size, size_t i) {
+	for (; i + 16 <= size; i += 16) {
+		__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buf + i));
+		__m128i stop = _mm_or_si128(sse2AtMost(v, 0x1F), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+		int mask = _mm_movemask_epi8(stop);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return scalarValueRun(buf, size, i);
+}
+
+static size_t sse2FindCRLF(const char *buf, size_t size) { return sse2FindCRLFFrom(buf, size, 0); }
+static size_t sse2TokenRun(const char *buf, size_t size) { return sse2TokenRunFrom(buf, size, 0); }
+static size_t sse2UriRun(const char *buf, size_t size) { return sse2UriRunFrom(buf, size, 0); }
+static size_t sse2ValueRun(const char *buf, size_t size) { return sse2ValueRunFrom(buf, size, 0); }
+
+/* AVX2 */
+
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+TARGET_AVX2 static inline __m256i avx2AtMost(__m256i v, char n) {
+	__m256i limit = _mm256_set1_epi8(n);
+	return _mm256_cmpeq_epi8(_mm256_max_epu8(v, limit), limit);
+}
+
+TARGET_AVX2 static inline __m256i avx2InRange(__m256i v, char low, char high) {
+	return avx2AtMost(_mm256_sub_epi8(v, _mm256_set1_epi8(low)), static_cast<char>(high - low));
+}
+
+TARGET_AVX2 static inline unsigned avx2Mask(__m256i v) {
+	return static_cast<unsigned>(_mm256_movemask_epi8(v));
+}
+
+TARGET_AVX2 static size_t avx2FindCRLF(const char *buf, size_t size) {
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i lf = _mm256_set1_epi8('\n');
+	size_t i = 0;
+	for (; i + 33 <= size; i += 32) {
+		__m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + i));
+		__m256i next = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + i + 1));
+		unsigned mask = avx2Mask(
+		    _mm256_and_si256(_mm256_cmpeq_epi8(first, cr), _mm256_cmpeq_epi8(next, lf)));
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return sse2FindCRLFFrom(buf, size, i);
+}
+
+TARGET_AVX2 static size_t avx2TokenRun(const char *buf, size_t size) {
+	size_t i = 0;
+	for (;;) {
+		for (; i + 32 <= size; i += 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + i));
+			__m256i ok =
+			    _mm256_or_si256(avx2InRange(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), 'a', 'z'),
+			                    avx2InRange(v, '0', '9'));
+			ok = _mm256_or_si256(ok, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('-')));
+			unsigned mask = ~avx2Mask(ok);
+			if (mask) {
+				i += __builtin_ctz(mask);
+				break;
+			}
+		}
+		if (i + 32 > size)
+			return sse2TokenRunFrom(buf, size, i);
+		if (!isToken(byteAt(buf, i)))
+			return i;
+		++i;
+	}
+}
+
+TARGET_AVX2 static size_t avx2UriRun(const char *buf, size_t size) {
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + i));
+		__m256i stop = _mm256_xor_si256(avx2InRange(v, 0x21, 0x7E), _mm256_set1_epi8(-1));
+		stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('%')));
+		stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+		stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\'')));
+		stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+		unsigned mask = avx2Mask(stop);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return sse2UriRunFrom(buf, size, i);
+}
+
+TARGET_AVX2 static size_t avx2ValueRun(const char *buf, size_t size) {
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buf + i));
+		__m256i stop =
+		    _mm256_or_si256(avx2AtMost(v, 0x1F), _mm256_cmpeq_epi8(v, _mm256_set1_epi8(0x7F)));
+		unsigned mask = avx2Mask(stop);
+		if (mask)
+			return i + __builtin_ctz(mask);
+	}
+	return sse2ValueRunFrom(buf, size, i);
+}
+
+#undef TARGET_AVX2
+#undef ALWAYS_INLINE
+
+#endif
+
+/* Dispatch */
+
+namespace {
+struct Kernels {
+	ByteScan::Isa isa;
+	size_t (*findCRLF)(const char *, size_t);
+	size_t (*tokenRun)(const char *, size_t);
+	size_t (*uriRun)(const char *, size_t);
+	size_t (*valueRun)(const char *, size_t);
+};
+
+const Kernels scalar_kernels = {ByteScan::SCALAR, scalarFindCRLF, scalarTokenRun, scalarUriRun,
+                                scalarValueRun};
+#ifdef BYTE_SCAN_X86
+const Kernels sse2_kernels = {ByteScan::SSE2, sse2FindCRLF, sse2TokenRun, sse2UriRun,
+                              sse2ValueRun};
+const Kernels avx2_kernels = {ByteScan::AVX2, avx2FindCRLF, avx2TokenRun, avx2UriRun,
+                              avx2ValueRun};
+#endif
+
+const Kernels *kernelsFor(ByteScan::Isa isa) {
+#ifdef BYTE_SCAN_X86
+	if (isa == ByteScan::AVX2)
+		return &avx2_kernels;
+	if (isa == ByteScan::SSE2)
+		return &sse2_kernels;
+#endif
+	(void)isa;
+	return &scalar_kernels;
+}
+
+// Chosen during static initialization, before main() starts any thread
+const Kernels *kernels = kernelsFor(ByteScan::detected());
+} // namespace
+
+ByteScan::Isa ByteScan::detected() {
+#ifdef BYTE_SCAN_X86
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+		return AVX2;
+	if (__builtin_cpu_supports("sse2"))
+		return SSE2;
+#endif
+	return SCALAR;
+}
+
+ByteScan::Isa ByteScan::active() { return kernels->isa; }
+
+bool ByteScan::use(Isa isa) {
+	if (isa > detected())
+		return false;
+	kernels = kernelsFor(isa);
+	return true;
+}
+
+const char *ByteScan::name(Isa isa) {
+	if (isa == AVX2)
+		return "avx2";
+	if (isa == SSE2)
+		return "sse2";
+	return "scalar";
+}
+
+size_t ByteScan::findCRLF(const char *buf, size_t size) { return kernels->findCRLF(buf, size); }
+
+size_t ByteScan::tokenRun(const char *buf, size_t size) { return kernels->tokenRun(buf, size); }
+
+size_t ByteScan::uriRun(const char *buf, size_t size) { return kernels->uriRun(buf, size); }
+
+size_t ByteScan::valueRun(const char *buf, size_t size) { return kernels->valueRun(buf, size); }
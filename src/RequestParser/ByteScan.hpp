@@ -0,0 +1,69 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ByteScan.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/03 09:41:18 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/03 09:41:18 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BYTE_SCAN_HPP
+#define BYTE_SCAN_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Scanning kernels of the request parser, which skip runs of bytes of one
+/// class 16 (SSE2) or 32 (AVX2) bytes at a time.
+///
+/// The implementation is chosen once at startup from what the CPU supports
+/// (cpuid), with a byte-at-a-time fallback that gives the same results on
+/// any machine. Each run function returns how many bytes from the start are
+/// in its class, so the caller only looks at the byte that ends the run.
+namespace ByteScan {
+enum Isa { SCALAR, SSE2, AVX2 };
+
+extern const unsigned char token_chars[256];
+
+/// tchar of RFC 9110: what methods and header names are made of.
+inline bool isToken(unsigned char c) { return token_chars[c]; }
+
+/// Printable ASCII, without the characters that must be percent-encoded.
+inline bool isUriChar(unsigned char c) {
+	return c > 0x20 && c < 0x7F && c != '"' && c != '\'' && c != '\\';
+}
+
+/// Field values: visible characters, spaces, tabs and obs-text.
+inline bool isValueChar(unsigned char c) { return c >= 0x20 ? c != 0x7F : c == '\t'; }
+
+/// \returns The best implementation this CPU supports.
+Isa detected();
+
+/// \returns The implementation in use.
+Isa active();
+
+/// Switches implementation, for benchmarks and tests (not thread-safe).
+/// \returns false if the CPU does not support it; the current one is kept.
+bool use(Isa isa);
+
+const char *name(Isa isa);
+
+/// \returns Offset of the first "\r\n" in buf, or size if there is none.
+size_t findCRLF(const char *buf, size_t size);
+
+/// \returns Length of the leading run of tchar (the bytes of methods and
+///          header names).
+size_t tokenRun(const char *buf, size_t size);
+
+/// \returns Length of the leading run of URI bytes that need no attention:
+///          stops at '%', at a space and at anything not allowed in a URI.
+size_t uriRun(const char *buf, size_t size);
+
+/// \returns Length of the leading run of header value bytes: stops at
+///          control characters (CR, LF, tab, ...) and DEL.
+size_t valueRun(const char *buf, size_t size);
+} // namespace ByteScan
+
+#endif
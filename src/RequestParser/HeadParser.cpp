@@ -0,0 +1,221 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HeadParser.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/02 10:14:37 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/02 10:14:37 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "HeadParser.hpp"
+#include "ByteScan.hpp"
+
+using ByteScan::isToken;
+using ByteScan::isUriChar;
+using ByteScan::isValueChar;
+
+static inline char toLower(char c) { return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+
+// Bytes from pos that a token started at mark may still take before max
+static inline size_t runLimit(size_t pos, size_t size, size_t mark, size_t max) {
+	size_t end = std::min(size, mark + max);
+	return end > pos ? end - pos : 0;
+}
+
+HeadParser::HeadParser() { reset(); }
+
+void HeadParser::reset() {
+	_state = START;
+	_status = INCOMPLETE;
+	_pos = 0;
+	_mark = 0;
+	_value_end = 0;
+	_method.offset = _method.length = 0;
+	_uri = _version = _name = _method;
+	_name_id = RequestHeaders::UNKNOWN;
+	_uri_encoded = false;
+	_headers.clear();
+	std::fill(_first, _first + RequestHeaders::WELL_KNOWN_COUNT, -1);
+	_error = 0;
+	_reason = NULL;
+}
+
+HeadParser::Status HeadParser::fail(uint16_t code, const char *reason) {
+	_error = code;
+	_reason = reason;
+	_status = FAILED;
+	return _status;
+}
+
+HeadParser::Status HeadParser::parse(const char *buf, size_t size) {
+	if (_status != INCOMPLETE)
+		return _status;
+	size_t pos = _pos;
+	State state = _state;
+	for (; pos < size; ++pos) {
+		pos += skipRun(state, buf, pos, size);
+		if (pos == size)
+			break;
+		unsigned char c = static_cast<unsigned char>(buf[pos]);
+		switch (state) {
+		case START:
+			if (c == '\r')
+				state = START_LF;
+			else if (isToken(c)) {
+				_mark = pos;
+				state = METHOD;
+			} else
+				return fail(400, "Invalid request line");
+			break;
+
+		case START_LF:
+			if (c != '\n')
+				return fail(400, "Invalid line ending");
+			state = START;
+			break;
+
+		case METHOD:
+			if (c == ' ') {
+				_method.offset = _mark;
+				_method.length = pos - _mark;
+				_mark = pos + 1;
+				state = URI;
+			} else if (!isToken(c))
+				return fail(400, "Invalid method");
+			break;
+
+		case URI:
+			if (c == ' ') {
+				if (pos == _mark)
+					return fail(400, "Extra spaces in request line");
+				_uri.offset = _mark;
+				_uri.length = pos - _mark;
+				_mark = pos + 1;
+				state = VERSION;
+			} else if (!isUriChar(c))
+				return fail(400, c == '\r' ? "Request line missing spaces" : "Invalid uri");
+			else if (pos - _mark >= MAX_URI_LENGTH)
+				return fail(414, "Uri too big");
+			else if (c == '%')
+				_uri_encoded = true;
+			break;
+
+		case VERSION:
+			if (c == '\r') {
+				_version.offset = _mark;
+				_version.length = pos - _mark;
+				if (_version.length != 8 || std::memcmp(buf + _mark, "HTTP/1.1", 8) != 0) {
+					if (_version.length > 5 && std::memcmp(buf + _mark, "HTTP/", 5) == 0)
+						return fail(505, "Invalid HTTP version");
+					return fail(400, "Invalid request line format");
+				}
+				state = LINE_LF;
+			} else if (c == ' ' || pos - _mark >= 8)
+				return fail(400, "Invalid request line format");
+			break;
+
+		case LINE_LF:
+		case VALUE_LF:
+			if (c != '\n')
+				return fail(400, "Invalid line ending");
+			state = HEADER_START;
+			break;
+
+		case HEADER_START:
+			if (c == '\r')
+				state = END_LF;
+			else if (isToken(c)) {
+				if (_headers.size() >= MAX_HEADER_COUNT)
+					return fail(431, "Too many headers");
+				_mark = pos;
+				state = NAME;
+			} else
+				return fail(400, c == ' ' || c == '\t' ? "Obsolete line folding"
+				                                       : "Invalid header format");
+			break;
+
+		case NAME:
+			if (c == ':') {
+				_name.offset = _mark;
+				_name.length = pos - _mark;
+				_name_id = RequestHeaders::lookup(buf + _mark, _name.length);
+				state = VALUE_START;
+			} else if (!isToken(c))
+				return fail(400, "Invalid character in header name");
+			else if (pos - _mark >= MAX_HEADER_NAME_LENGTH)
+				return fail(431, "Header name too big");
+			break;
+
+		case VALUE_START:
+			if (c == ' ' || c == '\t')
+				break;
+			_mark = pos;
+			_value_end = pos;
+			state = VALUE;
+			// fall through - the first byte of the value
+		case VALUE:
+			if (c == '\r') {
+				Header header;
+				header.name = _name;
+				header.id = _name_id;
+				if (_name_id != RequestHeaders::UNKNOWN && _first[_name_id] < 0)
+					_first[_name_id] = static_cast<int>(_headers.size());
+				header.value.offset = _mark;
+				header.value.length = _value_end - _mark;
+				_headers.push_back(header);
+				state = VALUE_LF;
+			} else if (!isValueChar(c))
+				return fail(400, "Invalid character in header value");
+			else if (pos - _mark >= MAX_HEADER_VALUE_LENGTH)
+				return fail(431, "Header value too big");
+			else if (c != ' ' && c != '\t')
+				_value_end = pos + 1;
+			break;
+
+		case END_LF:
+			if (c != '\n')
+				return fail(400, "Invalid line ending");
+			_pos = pos + 1;
+			_state = DONE;
+			_status = COMPLETE;
+			return _status;
+
+		case DONE:
+			break;
+		}
+	}
+	_pos = pos;
+	_state = state;
+	if (_pos > MAX_HEAD_LENGTH)
+		return fail(431, "Request head too big");
+	return _status;
+}
+
+size_t HeadParser::skipRun(State state, const char *buf, size_t pos, size_t size) {
+	size_t run = 0;
+	if (state == URI)
+		run = ByteScan::uriRun(buf + pos, runLimit(pos, size, _mark, MAX_URI_LENGTH));
+	else if (state == NAME)
+		run = ByteScan::tokenRun(buf + pos, runLimit(pos, size, _mark, MAX_HEADER_NAME_LENGTH));
+	else if (state == VALUE) {
+		run = ByteScan::valueRun(buf + pos, runLimit(pos, size, _mark, MAX_HEADER_VALUE_LENGTH));
+		size_t end = pos + run;
+		while (end > pos && buf[end - 1] == ' ')
+			--end;
+		if (end > pos)
+			_value_end = end;
+	}
+	return run;
+}
+
+bool HeadParser::equals(const char *buf, const Span &span, const char *lower) {
+	const char *p = buf + span.offset;
+	for (size_t i = 0; i < span.length; ++i) {
+		if (lower[i] == '\0' || toLower(p[i]) != lower[i])
+			return false;
+	}
+	return lower[span.length] == '\0';
+}
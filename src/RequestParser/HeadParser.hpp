@@ -0,0 +1,137 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   HeadParser.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/02 10:14:37 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/02 10:14:37 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef HEAD_PARSER_HPP
+#define HEAD_PARSER_HPP
+
+#include "includes/Webserv.hpp"
+#include "RequestHeaders.hpp"
+
+const size_t MAX_URI_LENGTH = 2048;
+const size_t MAX_HEADER_NAME_LENGTH = 1024;
+const size_t MAX_HEADER_VALUE_LENGTH = 8000;
+const size_t MAX_HEADER_COUNT = 100;
+const size_t MAX_HEAD_LENGTH = 64 * 1024; // request line and headers together
+
+/// Resumable parser of the request line and headers, fed the connection's
+/// input as it arrives.
+///
+/// Each call continues from the byte where the previous one stopped, so every
+/// byte is looked at once, whatever the number of reads the head takes. Runs
+/// of plain bytes are skipped a vector at a time (see ByteScan). The
+/// parser copies nothing: the method, URI, version and each header name and
+/// value are recorded as offsets into the buffer, from the first byte of the
+/// request. The buffer may move between calls (only offsets are kept), but its
+/// bytes must stay in place until the request has been handled.
+class HeadParser {
+  public:
+	enum Status { INCOMPLETE, COMPLETE, FAILED };
+
+	/// A part of the buffer.
+	struct Span {
+		size_t offset;
+		size_t length;
+	};
+
+	/// A header, value without the surrounding whitespace.
+	struct Header {
+		Span name;
+		Span value;
+		RequestHeaders::Id id; // slot of the name, found once while parsing
+	};
+
+	HeadParser();
+
+	/// Forgets the current request, keeping the capacity of the header list.
+	void reset();
+
+	/// Parses the bytes that were not parsed yet.
+	/// \param buf First byte of the request.
+	/// \param size Bytes available from buf (may include the body and more).
+	/// \returns COMPLETE once the blank line ending the headers was parsed,
+	///          FAILED on a syntax error or a limit, INCOMPLETE otherwise.
+	Status parse(const char *buf, size_t size);
+
+	inline Status status() const { return _status; }
+
+	/// \returns The status code to answer a FAILED head with (400, 414, 431 or 505).
+	inline uint16_t error() const { return _error; }
+
+	/// \returns What failed, for the logs.
+	inline const char *reason() const { return _reason; }
+
+	/// \returns Bytes of the head including the final CRLF, once COMPLETE.
+	inline size_t length() const { return _pos; }
+
+	inline const Span &method() const { return _method; }
+	inline const Span &uri() const { return _uri; }
+	inline const Span &version() const { return _version; }
+	inline const std::vector<Header> &headers() const { return _headers; }
+
+	/// \returns Whether the URI contains percent-encoded bytes.
+	inline bool uriEncoded() const { return _uri_encoded; }
+
+	/// \returns The first header with a well-known name, NULL if none.
+	inline const Header *find(RequestHeaders::Id id) const {
+		return _first[id] < 0 ? NULL : &_headers[_first[id]];
+	}
+
+	/// \returns Whether a span equals a lowercase string, ignoring case.
+	static bool equals(const char *buf, const Span &span, const char *lower);
+
+	/// \returns A copy of a span.
+	static inline std::string str(const char *buf, const Span &span) {
+		return std::string(buf + span.offset, span.length);
+	}
+
+  private:
+	enum State {
+		START,        // empty lines allowed before the request line
+		START_LF,
+		METHOD,
+		URI,
+		VERSION,
+		LINE_LF,      // after the CR ending the request line
+		HEADER_START, // a header name or the CR of the blank line
+		NAME,
+		VALUE_START,  // whitespace after the colon
+		VALUE,
+		VALUE_LF,
+		END_LF,
+		DONE
+	};
+
+	State _state;
+	Status _status;
+	size_t _pos;       // next byte to parse
+	size_t _mark;      // first byte of the token being parsed
+	size_t _value_end; // one past the last non-whitespace byte of the value
+	Span _method;
+	Span _uri;
+	Span _version;
+	bool _uri_encoded;
+	Span _name;
+	RequestHeaders::Id _name_id;
+	std::vector<Header> _headers;
+	int _first[RequestHeaders::WELL_KNOWN_COUNT]; // index in _headers, -1 if none
+	uint16_t _error;
+	const char *_reason;
+
+	Status fail(uint16_t code, const char *reason);
+
+	/// Skips the bytes that need no decision in the current state (most of
+	/// the URI, header names and values), with ByteScan.
+	/// \returns Bytes skipped from pos; the byte there is parsed as usual.
+	size_t skipRun(State state, const char *buf, size_t pos, size_t size);
+};
+
+#endif
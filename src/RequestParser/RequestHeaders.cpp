@@ -0,0 +1,153 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RequestHeaders.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/04 10:22:41 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/04 10:22:41 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "RequestHeaders.hpp"
+
+// In Id order
+static const char *const well_known_names[RequestHeaders::WELL_KNOWN_COUNT] = {
+    "host",
+    "connection",
+    "content-length",
+    "content-type",
+    "transfer-encoding",
+    "expect",
+    "range",
+    "if-range",
+    "if-none-match",
+    "if-modified-since",
+    "accept",
+    "accept-encoding",
+    "accept-language",
+    "user-agent",
+    "cookie",
+    "referer",
+    "authorization",
+    "cache-control",
+    "origin",
+    "upgrade-insecure-requests",
+};
+
+static const size_t MIN_NAME_LENGTH = 4;  // "host"
+static const size_t MAX_NAME_LENGTH = 25; // "upgrade-insecure-requests"
+
+// Perfect hash of the names above, gperf style:
+//   (length + weights[first byte] + weights[last byte]) % 32
+// gives each a slot of its own. The weights were searched for offline; both
+// cases of a letter weigh the same, so the name needs no lowercasing. Adding
+// a name means searching for new weights.
+static const unsigned char weights[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  4,  0,  2,  0,  9,  0, 19,  9, 22,  0,  0,  7,  0, 29,  2,
+     0,  0, 19, 20, 14,  6,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  4,  0,  2,  0,  9,  0, 19,  9, 22,  0,  0,  7,  0, 29,  2,
+     0,  0, 19, 20, 14,  6,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+static const RequestHeaders::Id slots[32] = {
+    RequestHeaders::UNKNOWN,           RequestHeaders::RANGE,
+    RequestHeaders::UNKNOWN,           RequestHeaders::UNKNOWN,
+    RequestHeaders::UNKNOWN,           RequestHeaders::ORIGIN,
+    RequestHeaders::ACCEPT_ENCODING,   RequestHeaders::IF_RANGE,
+    RequestHeaders::UNKNOWN,           RequestHeaders::CONNECTION,
+    RequestHeaders::UNKNOWN,           RequestHeaders::UNKNOWN,
+    RequestHeaders::IF_NONE_MATCH,     RequestHeaders::REFERER,
+    RequestHeaders::AUTHORIZATION,     RequestHeaders::UNKNOWN,
+    RequestHeaders::IF_MODIFIED_SINCE, RequestHeaders::COOKIE,
+    RequestHeaders::TRANSFER_ENCODING, RequestHeaders::UPGRADE_INSECURE_REQUESTS,
+    RequestHeaders::UNKNOWN,           RequestHeaders::UNKNOWN,
+    RequestHeaders::CACHE_CONTROL,     RequestHeaders::CONTENT_TYPE,
+    RequestHeaders::ACCEPT,            RequestHeaders::CONTENT_LENGTH,
+    RequestHeaders::UNKNOWN,           RequestHeaders::HOST,
+    RequestHeaders::ACCEPT_LANGUAGE,   RequestHeaders::EXPECT,
+    RequestHeaders::USER_AGENT,        RequestHeaders::UNKNOWN,
+};
+
+static inline char toLower(char c) { return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c; }
+
+RequestHeaders::RequestHeaders() : _present(0) {}
+
+RequestHeaders::Id RequestHeaders::lookup(const char *name, size_t length) {
+	if (length < MIN_NAME_LENGTH || length > MAX_NAME_LENGTH)
+		return UNKNOWN;
+	size_t hash = length + weights[static_cast<unsigned char>(name[0])] +
+	              weights[static_cast<unsigned char>(name[length - 1])];
+	Id id = slots[hash % 32];
+	if (id == UNKNOWN)
+		return UNKNOWN;
+	const char *candidate = well_known_names[id];
+	for (size_t i = 0; i < length; ++i) {
+		if (candidate[i] == '\0' || toLower(name[i]) != candidate[i])
+			return UNKNOWN;
+	}
+	return candidate[length] == '\0' ? id : UNKNOWN;
+}
+
+const char *RequestHeaders::name(Id id) { return well_known_names[id]; }
+
+bool RequestHeaders::add(const char *name, size_t name_length, const char *value,
+                         size_t value_length, Id id) {
+	if (id != UNKNOWN) {
+		if (_present & (1u << id))
+			return false;
+		_present |= 1u << id;
+		_values[id].assign(value, value_length);
+		return true;
+	}
+	std::string lower(name, name_length);
+	for (size_t i = 0; i < lower.size(); ++i)
+		lower[i] = toLower(lower[i]);
+	if (find(lower))
+		return false;
+	_others.push_back(std::make_pair(lower, std::string(value, value_length)));
+	return true;
+}
+
+bool RequestHeaders::add(const char *name, size_t name_length, const char *value,
+                         size_t value_length) {
+	return add(name, name_length, value, value_length, lookup(name, name_length));
+}
+
+const std::string *RequestHeaders::find(const std::string &name) const {
+	Id id = lookup(name.data(), name.size());
+	if (id != UNKNOWN)
+		return get(id);
+	for (size_t i = 0; i < _others.size(); ++i) {
+		if (_others[i].first == name)
+			return &_others[i].second;
+	}
+	return NULL;
+}
+
+size_t RequestHeaders::size() const {
+	size_t count = _others.size();
+	for (uint32_t present = _present; present; present &= present - 1)
+		++count;
+	return count;
+}
+
+void RequestHeaders::clear() {
+	for (int id = 0; id < WELL_KNOWN_COUNT; ++id)
+		_values[id].clear();
+	_present = 0;
+	_others.clear();
+}
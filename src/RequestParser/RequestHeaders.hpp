@@ -0,0 +1,93 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   RequestHeaders.hpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/04 10:22:41 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/04 10:22:41 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REQUEST_HEADERS_HPP
+#define REQUEST_HEADERS_HPP
+
+#include "includes/Webserv.hpp"
+
+/// Headers of a request.
+///
+/// The headers the server reads, and those most clients send, have a fixed
+/// slot: a lookup by Id is an array index. Their names are recognized with a
+/// perfect hash (see lookup()). Any other header goes to a small overflow
+/// list, under its lowercase name.
+class RequestHeaders {
+  public:
+	enum Id {
+		HOST,
+		CONNECTION,
+		CONTENT_LENGTH,
+		CONTENT_TYPE,
+		TRANSFER_ENCODING,
+		EXPECT,
+		RANGE,
+		IF_RANGE,
+		IF_NONE_MATCH,
+		IF_MODIFIED_SINCE,
+		ACCEPT,
+		ACCEPT_ENCODING,
+		ACCEPT_LANGUAGE,
+		USER_AGENT,
+		COOKIE,
+		REFERER,
+		AUTHORIZATION,
+		CACHE_CONTROL,
+		ORIGIN,
+		UPGRADE_INSECURE_REQUESTS,
+		WELL_KNOWN_COUNT,
+		UNKNOWN = -1
+	};
+
+	typedef std::vector<std::pair<std::string, std::string> > OtherList;
+
+	RequestHeaders();
+
+	/// Finds the slot of a header name, ignoring case.
+	/// \returns Its Id, or UNKNOWN if it has no slot.
+	static Id lookup(const char *name, size_t length);
+
+	/// \returns Lowercase name of a well-known header.
+	static const char *name(Id id);
+
+	/// Adds a header.
+	/// \param id lookup() of the name, if already known; computed otherwise.
+	/// \returns false if the request already has a header of that name.
+	bool add(const char *name, size_t name_length, const char *value, size_t value_length,
+	         Id id);
+	bool add(const char *name, size_t name_length, const char *value, size_t value_length);
+
+	/// \returns The value of a well-known header, NULL if absent.
+	inline const std::string *get(Id id) const {
+		return (_present & (1u << id)) ? &_values[id] : NULL;
+	}
+
+	/// \returns The value of a well-known header, empty if absent.
+	inline const std::string &value(Id id) const { return _values[id]; }
+
+	/// \returns The value of any header, NULL if absent.
+	/// \param name Lowercase name.
+	const std::string *find(const std::string &name) const;
+
+	/// \returns The headers without a slot, in the order received.
+	inline const OtherList &others() const { return _others; }
+
+	size_t size() const;
+	void clear();
+
+  private:
+	uint32_t _present; // bit per Id
+	std::string _values[WELL_KNOWN_COUNT];
+	OtherList _others;
+};
+
+#endif
@@ -32,6 +32,12 @@ bool decodeNValidateUri(const std::string &uri, std::string &decoded) {
 	decoded.reserve(uri.length());
 
 	for (std::string::size_type i = 0; i < uri.length(); ++i) {
+		// Plain bytes are copied as a whole; only '%' and invalid ones end a run
+		size_t run = ByteScan::uriRun(uri.data() + i, uri.length() - i);
+		decoded.append(uri, i, run);
+		i += run;
+		if (i == uri.length())
+			break;
 		char ch = uri[i];
 
 		if (ch == '%') {
@@ -73,33 +79,20 @@ bool decodeNValidateUri(const std::string &uri, std::string &decoded) {
 	return (true);
 }
 
-/* Checks */
-bool RequestParsingUtils::checkReqLine(ClientRequest &request) {
+/* Building */
+bool RequestParsingUtils::buildReqLine(const HeadParser &head, const char *buf,
+                                       ClientRequest &request) {
 	Logger logger;
 
-	if (request.method.empty() || request.uri.empty() || request.version.empty()) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Empty component in request line");
-		return (false);
-	}
-
-	if (request.method.find(' ') != std::string::npos ||
-	    request.uri.find(' ') != std::string::npos ||
-	    request.version.find(' ') != std::string::npos) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Extra spaces in request line");
-		return (false);
-	}
-
-	if (request.uri.length() > MAX_URI_LENGTH) {
-		g_error_status = 414;
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Uri too big");
-		return (false);
-	}
-	std::string decoded_uri;
-	if (!decodeNValidateUri(request.uri, decoded_uri)) {
+	// Syntax, length and version were checked by the HeadParser
+	request.method = HeadParser::str(buf, head.method());
+	request.version = HeadParser::str(buf, head.version());
+	if (!head.uriEncoded())
+		request.uri = HeadParser::str(buf, head.uri());
+	else if (!decodeNValidateUri(HeadParser::str(buf, head.uri()), request.uri)) {
 		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid uri");
 		return (false);
 	}
-	request.uri = decoded_uri;
 	size_t qm = request.uri.find_first_of('?');
 	if (qm != std::string::npos) {
 		request.path = request.uri.substr(0, qm);
@@ -108,62 +101,5 @@ bool RequestParsingUtils::checkReqLine(ClientRequest &request) {
 		request.path = request.uri;
 		request.query = "";
 	}
-	// case 505: "HTTP Version Not Supported"
-	if (request.version != "HTTP/1.1") {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid HTTP version");
-		g_error_status = 505;
-		return (false);
-	}
-
 	return (true);
 }
-
-/* Parsing */
-bool RequestParsingUtils::parseReqLine(std::istringstream &stream, ClientRequest &request) {
-	Logger logger;
-	std::string line;
-	logger.logWithPrefix(Logger::DEBUG, "HTTP", "Parsing request line");
-
-	if (!std::getline(stream, line)) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "No request line present");
-		return (false);
-	}
-
-	if (!line.empty() && line[line.length() - 1] == '\r')
-		line.erase(line.length() - 1);
-
-	std::string trimmed_line = trimSide(line, 3);
-
-	// Check for proper format: exactly one space between each component
-	size_t first_space = trimmed_line.find(' ');
-	if (first_space == std::string::npos) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Request line missing spaces");
-		return (false);
-	}
-
-	size_t second_space = trimmed_line.find(' ', first_space + 1);
-	if (second_space == std::string::npos) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid request line format");
-		return (false);
-	}
-
-	// Check for extra spaces between components
-	if (first_space == 0 || second_space == first_space + 1) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP",
-		                     "Extra spaces between request line components");
-		return (false);
-	}
-
-	// Check for trailing spaces or extra spaces after version
-	if (trimmed_line.find(' ', second_space + 1) != std::string::npos) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "Extra spaces after HTTP version");
-		return (false);
-	}
-
-	// Manual parsing to ensure exactly one space between components
-	request.method = trimmed_line.substr(0, first_space);
-	request.uri = trimmed_line.substr(first_space + 1, second_space - first_space - 1);
-	request.version = trimmed_line.substr(second_space + 1);
-
-	return (RequestParsingUtils::checkReqLine(request));
-}
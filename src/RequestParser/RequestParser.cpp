@@ -22,106 +22,28 @@ std::string ClientRequest::toString() {
 	oss << "version: " << version << ", ";
 
 	oss << "headers: [";
-	for (std::map<std::string, std::string>::const_iterator it = headers.begin();
-	     it != headers.end(); ++it) {
-		oss << it->first << ":" << it->second << ", ";
+	for (int id = 0; id < RequestHeaders::WELL_KNOWN_COUNT; ++id) {
+		RequestHeaders::Id header = static_cast<RequestHeaders::Id>(id);
+		if (headers.get(header))
+			oss << RequestHeaders::name(header) << ":" << headers.value(header) << ", ";
 	}
+	for (size_t i = 0; i < headers.others().size(); ++i)
+		oss << headers.others()[i].first << ":" << headers.others()[i].second << ", ";
 	oss << "], ";
 
 	oss << "chunked-encoding: " << (chunked_encoding ? "true" : "false") << ", ";
 
-	if (!body.empty()) {
-		oss << "body: \"" << body << "\", ";
-	} else {
-		oss << "body: <empty>, ";
-	}
-
 	oss << "clfd: " << clfd << "}";
 
 	return (oss.str());
 }
 
-/* Utils */
-const char *RequestParsingUtils::findHeader(ClientRequest &request, const std::string &header) {
-	std::map<std::string, std::string>::iterator it = request.headers.find(header);
-	if (it == request.headers.end())
-		return (NULL);
-	return (it->second.c_str());
-}
-
-// Trim type: 1=left side, 2=right side, 3=both
-std::string RequestParsingUtils::trimSide(const std::string &s, int type) {
-	std::string result = s;
-	if (type == 1 || type == 3) {
-		while (!result.empty() && (result[0] == ' ' || result[0] == '\t'))
-			result.erase(0, 1);
-	}
-	if (type == 2 || type == 3) {
-		while (!result.empty() &&
-		       (result[result.size() - 1] == ' ' || result[result.size() - 1] == '\t'))
-			result.erase(result.size() - 1);
-	}
-	return (result);
-}
-
-/* Trailing headers parser */
-bool RequestParsingUtils::parseTrailingHeaders(std::istringstream &stream, ClientRequest &request) {
-	Logger logger;
-	std::string line;
-	logger.logWithPrefix(Logger::INFO, "HTTP", "Parsing trailing headers");
-
-	while (std::getline(stream, line)) {
-		// Check if end of request
-		if (!line.empty() && line[line.length() - 1] == '\r')
-			line.erase(line.length() - 1);
-
-		if (line.empty())
-			return (true);
-
-		size_t colon = line.find(':');
-		if (colon == std::string::npos) {
-			logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid trailing header");
-			return (false);
-		}
-		std::string name = trimSide(line.substr(0, colon), 1);
-		std::string value = trimSide(line.substr(colon + 1), 3);
-
-		if (name.empty()) {
-			logger.logWithPrefix(Logger::WARNING, "HTTP", "Empty header name");
-			return (false);
-		}
-		// Check for spaces in header name (invalid according to HTTP spec)
-		if (name.find(' ') != std::string::npos || name.find('\t') != std::string::npos) {
-			logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid header name (contains spaces)");
-			return (false);
-		}
-		// Check for valid header name characters
-		for (size_t i = 0; i < name.length(); ++i) {
-			char c = name[i];
-			if (!std::isalnum(c) && c != '-' && c != '_') {
-				logger.logWithPrefix(Logger::WARNING, "HTTP",
-				                     "Invalid character in header name: " + name);
-				return (false);
-			}
-		}
-		// Check for valid header to be in trailing
-		if (su::to_lower(name) == "te" || su::to_lower(name) == "connection") {
-			logger.logWithPrefix(Logger::WARNING, "HTTP", "Invalid headers to be in trailing");
-			return (false);
-		}
-		if (!checkHeader(name, value, request))
-			return (false);
-		request.headers[su::to_lower(name)] = value;
-	}
-	return (true);
-}
-
 bool checkFileUpload(ClientRequest &request) {
 	Logger logger;
 	bool type = false;
 	bool bound = false;
 
-	std::string content_type = request.headers["content-type"];
+	const std::string &content_type = request.headers.value(RequestHeaders::CONTENT_TYPE);
 	if (content_type.find("multipart/form-data") != std::string::npos)
 		type = true;
 	if (content_type.find("boundary=") != std::string::npos)
@@ -137,36 +59,29 @@ bool checkFileUpload(ClientRequest &request) {
 }
 
 /* Parser */
-bool RequestParsingUtils::parseRequest(const std::string &raw_request, ClientRequest &request) {
+bool RequestParsingUtils::parseRequest(const HeadParser &head, const char *buf, size_t body_size,
+                                       ClientRequest &request) {
 	Logger logger;
-	if (raw_request.empty()) {
-		logger.logWithPrefix(Logger::WARNING, "HTTP", "No request received");
+	g_error_status = 400; // unless the head has a more specific code
+	if (head.status() != HeadParser::COMPLETE) {
+		logger.logWithPrefix(Logger::WARNING, "HTTP",
+		                     head.reason() ? head.reason() : "Missing final CRLF");
+		if (head.status() == HeadParser::FAILED)
+			g_error_status = head.error();
 		return (false);
 	}
 
 	request.chunked_encoding = false;
 	request.file_upload = false;
 	request.extension = "";
-	std::istringstream stream(raw_request);
 
-	// Parse request line
-	if (!parseReqLine(stream, request))
+	if (!buildReqLine(head, buf, request))
 		return (false);
-
-	// Parse headers
-	if (!parseHeaders(stream, request))
+	if (!buildHeaders(head, buf, request))
 		return (false);
-
-	// Parse body
-	if (!parseBody(stream, request))
+	if (!parseBody(body_size, request))
 		return (false);
 
-	// Parse trailing headers (if any)
-	if (request.chunked_encoding) {
-		if (!parseTrailingHeaders(stream, request))
-			return (false);
-	}
-
 	// Check if file upload
 	if (!checkFileUpload(request))
 		return (false);
@@ -174,3 +89,16 @@ bool RequestParsingUtils::parseRequest(const std::string &raw_request, ClientReq
 	logger.logWithPrefix(Logger::INFO, "HTTP", "Request parsing completed");
 	return (true);
 }
+
+bool RequestParsingUtils::parseRequest(const std::string &raw_request, ClientRequest &request) {
+	Logger logger;
+	if (raw_request.empty()) {
+		logger.logWithPrefix(Logger::WARNING, "HTTP", "No request received");
+		return (false);
+	}
+	HeadParser head;
+	head.parse(raw_request.data(), raw_request.size());
+	// The body follows the head
+	size_t body_size = raw_request.size() - head.length();
+	return (parseRequest(head, raw_request.data(), body_size, request));
+}
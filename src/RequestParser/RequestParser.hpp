@@ -16,23 +16,17 @@
 #include "includes/Types.hpp"
 #include "includes/Webserv.hpp"
 #include "src/Logger/Logger.hpp"
+#include "src/RequestParser/ByteScan.hpp"
+#include "src/RequestParser/HeadParser.hpp"
 #include "src/Utils/GeneralUtils.hpp"
 #include "src/Utils/StringUtils.hpp"
 
-const size_t MAX_URI_LENGTH = 2048;
-const size_t MAX_HEADER_NAME_LENGTH = 1024;
-const size_t MAX_HEADER_VALUE_LENGTH = 8000;
-
 namespace RequestParsingUtils {
-bool checkNTrimLine(std::string &line);
-const char *findHeader(ClientRequest &request, const std::string &header);
-std::string trimSide(const std::string &s, int type);
-bool checkReqLine(ClientRequest &request);
-bool parseReqLine(std::istringstream &stream, ClientRequest &request);
-bool checkHeader(std::string &name, std::string &value, ClientRequest &request);
-bool parseHeaders(std::istringstream &stream, ClientRequest &request);
-bool parseBody(std::istringstream &stream, ClientRequest &request);
-bool parseTrailingHeaders(std::istringstream &stream, ClientRequest &request);
+bool buildReqLine(const HeadParser &head, const char *buf, ClientRequest &request);
+bool buildHeaders(const HeadParser &head, const char *buf, ClientRequest &request);
+bool parseBody(size_t size, ClientRequest &request);
+bool parseRequest(const HeadParser &head, const char *buf, size_t body_size,
+                  ClientRequest &request);
 bool parseRequest(const std::string &raw_request, ClientRequest &request);
 } // namespace RequestParsingUtils
 
@@ -0,0 +1,156 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_headers.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/04 14:37:09 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/04 14:37:09 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Storing the headers of a parsed head and reading the ones a static GET
+// looks at: the old std::map keyed by lowercase names, looked up with
+// std::string temporaries, against RequestHeaders and its fixed slots.
+//
+// usage: ./bench_headers [requests]
+
+#include "../RequestParser.hpp"
+
+__thread uint16_t g_error_status = 0;
+
+static const char request[] =
+    "GET /static/js/app.3f2a1c.js?v=1812 HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: */*\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Referer: https://www.example.com/index.html\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "If-None-Match: \"ce802f-19-6ad40967\"\r\n"
+    "\r\n";
+
+typedef std::map<std::string, std::string> HeaderMap;
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// What the previous findHeader() did
+static const char *findHeader(HeaderMap &headers, const std::string &name) {
+	HeaderMap::iterator it = headers.find(name);
+	return it == headers.end() ? NULL : it->second.c_str();
+}
+
+static bool buildMap(const HeadParser &head, const char *buf, HeaderMap &headers) {
+	for (size_t i = 0; i < head.headers().size(); ++i) {
+		const HeadParser::Header &header = head.headers()[i];
+		std::string name = su::to_lower(HeadParser::str(buf, header.name));
+		if (!headers.insert(std::make_pair(name, HeadParser::str(buf, header.value))).second)
+			return false;
+	}
+	return true;
+}
+
+// Host, then the connection, compression, conditional and range checks
+static size_t readMap(HeaderMap &headers) {
+	size_t found = 0;
+	found += findHeader(headers, "host") != NULL;
+	found += findHeader(headers, "content-length") != NULL;
+	found += findHeader(headers, "connection") != NULL;
+	found += findHeader(headers, "accept-encoding") != NULL;
+	found += findHeader(headers, "range") != NULL;
+	found += findHeader(headers, "if-none-match") != NULL;
+	found += findHeader(headers, "if-modified-since") != NULL;
+	found += findHeader(headers, "if-range") != NULL;
+	return found;
+}
+
+static bool buildSlots(const HeadParser &head, const char *buf, RequestHeaders &headers) {
+	for (size_t i = 0; i < head.headers().size(); ++i) {
+		const HeadParser::Header &header = head.headers()[i];
+		if (!headers.add(buf + header.name.offset, header.name.length, buf + header.value.offset,
+		                 header.value.length, header.id))
+			return false;
+	}
+	return true;
+}
+
+static size_t readSlots(const RequestHeaders &headers) {
+	size_t found = 0;
+	found += headers.get(RequestHeaders::HOST) != NULL;
+	found += headers.get(RequestHeaders::CONTENT_LENGTH) != NULL;
+	found += headers.get(RequestHeaders::CONNECTION) != NULL;
+	found += headers.get(RequestHeaders::ACCEPT_ENCODING) != NULL;
+	found += headers.get(RequestHeaders::RANGE) != NULL;
+	found += headers.get(RequestHeaders::IF_NONE_MATCH) != NULL;
+	found += headers.get(RequestHeaders::IF_MODIFIED_SINCE) != NULL;
+	found += headers.get(RequestHeaders::IF_RANGE) != NULL;
+	return found;
+}
+
+int main(int argc, char **argv) {
+	size_t count = argc > 1 ? std::atoi(argv[1]) : 500000;
+	HeadParser head;
+	head.parse(request, sizeof(request) - 1);
+
+	// Every well-known name, in any case, must find its own slot only
+	for (int id = 0; id < RequestHeaders::WELL_KNOWN_COUNT; ++id) {
+		std::string name = RequestHeaders::name(static_cast<RequestHeaders::Id>(id));
+		std::string upper = su::to_upper(name);
+		if (RequestHeaders::lookup(name.data(), name.size()) != id ||
+		    RequestHeaders::lookup(upper.data(), upper.size()) != id ||
+		    RequestHeaders::lookup(name.data(), name.size() - 1) == id) {
+			std::cerr << "bad slot for " << name << std::endl;
+			return 1;
+		}
+	}
+	HeaderMap map;
+	RequestHeaders slots;
+	if (!buildMap(head, request, map) || !buildSlots(head, request, slots) ||
+	    readMap(map) != readSlots(slots) || map.size() != slots.size()) {
+		std::cerr << "map and slots differ" << std::endl;
+		return 1;
+	}
+	std::cout << head.headers().size() << " headers, " << readSlots(slots)
+	          << " of 8 lookups found, " << count << " requests" << std::endl;
+
+	size_t sum = 0;
+	double start = now();
+	for (size_t i = 0; i < count; ++i) {
+		HeaderMap headers;
+		sum += buildMap(head, request, headers) + readMap(headers);
+	}
+	double map_time = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i) {
+		RequestHeaders headers;
+		sum += buildSlots(head, request, headers) + readSlots(headers);
+	}
+	double slots_time = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		sum += readMap(map);
+	double map_read = now() - start;
+
+	start = now();
+	for (size_t i = 0; i < count; ++i)
+		sum += readSlots(slots);
+	double slots_read = now() - start;
+
+	std::cout << "std::map       : " << map_time * 1e9 / count << " ns/request, "
+	          << map_read * 1e9 / count << " ns of it for the lookups" << std::endl;
+	std::cout << "RequestHeaders : " << slots_time * 1e9 / count << " ns/request, "
+	          << slots_read * 1e9 / count << " ns of it for the lookups" << std::endl;
+	return sum == 0; // keeps the loops from being optimized out
+}
@@ -0,0 +1,98 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_parser.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/02 11:20:05 by jalombar          #+#    #+#             */
+/*   Updated: 2025/09/02 11:20:05 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Parser throughput on one core, for a browser GET of 13 headers:
+//  - head only: HeadParser::parse() over the whole request, offsets only
+//  - resumable: the same, fed as if the request arrived in small reads
+//  - full: parseRequest(), which also fills a ClientRequest (copies the
+//    method, path, query and headers into strings and maps)
+//
+// usage: ./bench_parser [requests] [read size]
+
+#include "../RequestParser.hpp"
+
+__thread uint16_t g_error_status = 0;
+
+static const char request[] =
+    "GET /static/js/app.3f2a1c.js?v=1812 HTTP/1.1\r\n"
+    "Host: www.example.com\r\n"
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;"
+    "q=0.8\r\n"
+    "Accept-Language: en-US,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+    "Referer: https://www.example.com/index.html\r\n"
+    "Connection: keep-alive\r\n"
+    "Cookie: session=8f14e45fceea167a5a36dedd4bea2543; theme=dark; "
+    "_ga=GA1.2.1234567890.1700000000\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "Sec-Fetch-Dest: script\r\n"
+    "Sec-Fetch-Mode: no-cors\r\n"
+    "Sec-Fetch-Site: same-origin\r\n"
+    "If-None-Match: \"ce802f-19-6ad40967\"\r\n"
+    "\r\n";
+
+static double now() {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void report(const char *name, size_t count, double seconds) {
+	std::cout << name << static_cast<size_t>(count / seconds) << " req/s, "
+	          << seconds * 1e9 / count << " ns/req" << std::endl;
+}
+
+int main(int argc, char **argv) {
+	size_t count = argc > 1 ? std::atoi(argv[1]) : 500000;
+	size_t step = argc > 2 ? std::atoi(argv[2]) : 64;
+	size_t size = sizeof(request) - 1;
+	if (step == 0)
+		step = 1;
+
+	ClientRequest check;
+	if (!RequestParsingUtils::parseRequest(request, check) || check.headers.size() != 13) {
+		std::cerr << "parse failed" << std::endl;
+		return 1;
+	}
+	std::cout << size << " byte request, " << count << " requests" << std::endl;
+
+	HeadParser head;
+	size_t sum = 0;
+	double start = now();
+	for (size_t i = 0; i < count; ++i) {
+		head.reset();
+		sum += head.parse(request, size) + head.headers().size();
+	}
+	report("head only : ", count, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < count; ++i) {
+		head.reset();
+		for (size_t end = step; head.status() == HeadParser::INCOMPLETE; end += step)
+			head.parse(request, std::min(end, size));
+		sum += head.length();
+	}
+	std::ostringstream name;
+	name << "resumable : " << "(" << step << " byte reads) ";
+	report(name.str().c_str(), count, now() - start);
+
+	start = now();
+	for (size_t i = 0; i < count; ++i) {
+		ClientRequest req;
+		head.reset();
+		head.parse(request, size);
+		sum += RequestParsingUtils::parseRequest(head, request, size - head.length(), req);
+	}
+	report("full      : ", count, now() - start);
+	return sum == 0; // keeps the loops from being optimized out
+}
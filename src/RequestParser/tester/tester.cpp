@@ -12,6 +12,8 @@
 
 #include "../RequestParser.hpp"
 
+__thread uint16_t g_error_status = 0; // defined by the server otherwise
+
 std::vector<std::pair<std::string, std::string> > test_requests;
 
 void init_requests() {
@@ -14,6 +14,7 @@
 #define ARGUMENTPARSER_HPP
 
 #include "includes/Webserv.hpp"
+#include "src/ConfigParser/ConfigParser.hpp"
 
 struct ServerArgs {
 	std::string config_file;
@@ -21,13 +22,17 @@ struct ServerArgs {
 	bool show_help;
 	bool show_version;
 	int log_level; // 0=error, 1=warn, 2=info, 3=debug
+	int workers;   // 0 = use the configuration file value
+	int threads;   // 0 = use the configuration file value
 
 	ServerArgs()
 	    : config_file(""),
 	      prefix_path(""),
 	      show_help(false),
 	      show_version(false),
-	      log_level(2) {}
+	      log_level(2),
+	      workers(0),
+	      threads(0) {}
 };
 
 class ArgumentParser {
@@ -43,6 +48,8 @@ class ArgumentParser {
 
 		known_flags.push_back("--prefix-path");
 		known_flags.push_back("--log-level");
+		known_flags.push_back("--workers");
+		known_flags.push_back("--threads");
 	}
 
 	ServerArgs parseArgs(int argc, char *argv[]) {
@@ -78,6 +85,26 @@ class ArgumentParser {
 			} else if (arg.find("--log-level=") == 0) {
 				args.log_level = parseLogLevel(arg.substr(12));
 
+			} else if (arg == "--workers") {
+				if (i + 1 < argc) {
+					args.workers = parseCount("--workers", argv[++i], MAX_WORKER_PROCESSES);
+				} else {
+					throw std::runtime_error("--workers requires a value");
+				}
+
+			} else if (arg.find("--workers=") == 0) {
+				args.workers = parseCount("--workers", arg.substr(10), MAX_WORKER_PROCESSES);
+
+			} else if (arg == "--threads") {
+				if (i + 1 < argc) {
+					args.threads = parseCount("--threads", argv[++i], MAX_WORKER_THREADS);
+				} else {
+					throw std::runtime_error("--threads requires a value");
+				}
+
+			} else if (arg.find("--threads=") == 0) {
+				args.threads = parseCount("--threads", arg.substr(10), MAX_WORKER_THREADS);
+
 			} else if (arg.find("--") == 0) {
 				throw std::runtime_error("Unknown option: " + arg);
 
@@ -103,6 +130,8 @@ class ArgumentParser {
 		std::cout << "  -v, --version           Show version information\n";
 		std::cout << "      --prefix-path PATH  Set prefix path for relative paths\n";
 		std::cout << "      --log-level LEVEL   Set log level (error|warn|info|debug)\n";
+		std::cout << "      --workers N         Run N worker processes (overrides worker_processes)\n";
+		std::cout << "      --threads N         Run N event-loop threads (overrides worker_threads)\n";
 		std::cout << "\nIf CONFIG_FILE is not specified, the following locations are tried:\n";
 
 		for (std::vector<std::string>::const_iterator it = default_config_paths.begin();
@@ -145,6 +174,16 @@ class ArgumentParser {
 		                         " (use: error|warn|info|debug or 0-3)");
 	}
 
+	// Same bounds as worker_processes and worker_threads in the configuration
+	int parseCount(const std::string &flag, const std::string &value, int max) {
+		std::istringstream iss(value);
+		int n;
+		if (!(iss >> n) || !iss.eof() || n < 1 || n > max)
+			throw std::runtime_error(flag + " must be between 1 and " + su::to_string(max) +
+			                         ". Value " + value);
+		return n;
+	}
+
 	std::string determineConfigFile(const std::vector<std::string> &positional_args) {
 		// If user provided a positional argument, assume it's the config file
 		if (!positional_args.empty()) {
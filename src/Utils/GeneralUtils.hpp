@@ -14,6 +14,7 @@
 #define GENERALUTILS_HPP
 
 #include "includes/Webserv.hpp"
+#include "src/RequestParser/ByteScan.hpp"
 
 inline std::string describeEpollEvents(uint32_t ev) {
 	std::vector<std::string> event_names;
@@ -47,8 +48,34 @@ inline std::string describeEpollEvents(uint32_t ev) {
 	return result;
 }
 
-inline size_t findCRLF(const std::string &buffer, size_t start_pos = 0) {
-	return buffer.find("\r\n", start_pos);
+/// \returns Offset of the first "\r\n" in data, or std::string::npos.
+inline size_t findCRLF(const char *data, size_t size) {
+	size_t pos = ByteScan::findCRLF(data, size);
+	return pos == size ? std::string::npos : pos;
+}
+
+/// Formats a time as an HTTP date (RFC 9110 IMF-fixdate).
+/// \param t Seconds since the epoch.
+/// \returns e.g. "Sun, 06 Nov 1994 08:49:37 GMT".
+inline std::string httpDate(time_t t) {
+	struct tm tm;
+	char buf[32];
+	gmtime_r(&t, &tm);
+	strftime(buf, sizeof(buf), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+	return buf;
+}
+
+/// Parses an HTTP date in the IMF-fixdate format, the only one servers must
+/// generate (the obsolete formats are treated as invalid).
+/// \param value Header value.
+/// \returns Seconds since the epoch, or -1 if the date is invalid.
+inline time_t parseHttpDate(const std::string &value) {
+	struct tm tm;
+	std::memset(&tm, 0, sizeof(tm));
+	const char *end = strptime(value.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+	if (!end || *end != '\0')
+		return -1;
+	return timegm(&tm);
 }
 
 #endif
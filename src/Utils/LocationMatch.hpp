@@ -16,50 +16,18 @@
 #include "includes/Webserv.hpp"
 #include "src/ConfigParser/ConfigParser.hpp"
 
-static bool isPrefixMatch(const std::string &uri, LocConfig &loc);
-
-
-/// Finds the location configuration that best matches a URI.
-/// \note The logic is very basic for now and needs to be improved in the future
+/// Finds the location configuration that best matches a URI: the longest
+/// location path that is the URI itself or a prefix of it ending at a '/'.
 /// \param uri The URI to match against location patterns.
-/// \param locations Vector of location configurations to search.
+/// \param server Server whose locations (and their trie) are searched.
+/// \param exact Set to whether the location path is the whole URI.
 /// \returns Pointer to the best matching LocConfig or / if no better match (nullptr if no match - impossible).
-inline LocConfig *findBestMatch(const std::string &uri, std::vector<LocConfig> &locations) {
-	for (std::vector<LocConfig>::iterator it = locations.begin(); it != locations.end(); ++it) {
-		if (isPrefixMatch(uri, *it)) {
-			return &(*it);
-		}
-	}
-	return NULL;
-}
-
-static bool isPrefixMatch(const std::string &uri, LocConfig &loc) {
-	Logger log;
-	std::string location_path = loc.getPath();
-
-	// reached only at last since the locconfig are sorted -> no better match 
-	if (location_path.empty() || location_path == "/") { 
-		return true;
-	}
-	if (uri.length() < location_path.length()) {
-		return false;
-	}
-	// Check for prefix
-	if (uri.substr(0, location_path.length()) != location_path) {
-		return false;
-	}
-	if (uri.length() == location_path.length()) {
-		loc.setExact(true);
-		std::cout << "\n\n\n\n\n\n EXACT MAtCH" << std::endl;
-		log.debug("EXACT PATH MATCH - uri : " + uri + " loc : " + location_path);
-		return true; // Exact match
-	}
-	if (loc.is_exact_()) {
-		return false;
-	}
-	// Next character should be '/' or end of string
-	char next_char = uri[location_path.length()];
-	return next_char == '/' || location_path[location_path.length() - 1] == '/';
+inline const LocConfig *findBestMatch(const std::string &uri, const ServerConfig &server,
+                                      bool &exact) {
+	int index = server.getLocationTrie().find(uri, exact);
+	if (index < 0)
+		return NULL;
+	return &server.getLocations()[index];
 }
 
 #endif
@@ -0,0 +1,72 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   MimeTypes.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: jalombar <jalombar@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/08/30 10:02:11 by jalombar          #+#    #+#             */
+/*   Updated: 2025/08/30 10:02:11 by jalombar         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MIMETYPES_HPP
+#define MIMETYPES_HPP
+
+#include "includes/Webserv.hpp"
+#include <strings.h> // for strcasecmp
+
+/// What the server knows about a file extension.
+struct MimeType {
+	const char *extension; ///< Without the dot
+	const char *type;      ///< Content-Type
+	bool compressible;     ///< Worth gzip: text formats, not images, media or archives
+};
+
+/// Finds the type of a path from its extension, ignoring case.
+/// \param path File path (a query string is ignored).
+/// \returns The entry, or the application/octet-stream one if unknown.
+inline const MimeType &mimeType(const std::string &path) {
+	static const MimeType types[] = {
+	    {"html", "text/html", true},
+	    {"htm", "text/html", true},
+	    {"css", "text/css", true},
+	    {"js", "application/javascript", true},
+	    {"mjs", "application/javascript", true},
+	    {"json", "application/json", true},
+	    {"map", "application/json", true},
+	    {"xml", "application/xml", true},
+	    {"txt", "text/plain", true},
+	    {"csv", "text/csv", true},
+	    {"md", "text/markdown", true},
+	    {"svg", "image/svg+xml", true},
+	    {"ico", "image/x-icon", true},
+	    {"wasm", "application/wasm", true},
+	    {"png", "image/png", false},
+	    {"jpg", "image/jpeg", false},
+	    {"jpeg", "image/jpeg", false},
+	    {"gif", "image/gif", false},
+	    {"webp", "image/webp", false},
+	    {"woff", "font/woff", false},
+	    {"woff2", "font/woff2", false},
+	    {"mp3", "audio/mpeg", false},
+	    {"mp4", "video/mp4", false},
+	    {"pdf", "application/pdf", false},
+	    {"zip", "application/zip", false},
+	    {"gz", "application/gzip", false},
+	    {NULL, "application/octet-stream", false}};
+
+	size_t end = path.find('?');
+	if (end == std::string::npos)
+		end = path.size();
+	size_t dot = path.find_last_of("./", end == 0 ? 0 : end - 1);
+	if (dot == std::string::npos || path[dot] != '.')
+		return types[sizeof(types) / sizeof(types[0]) - 1];
+	std::string ext = path.substr(dot + 1, end - dot - 1);
+	size_t i = 0;
+	while (types[i].extension && strcasecmp(types[i].extension, ext.c_str()) != 0)
+		++i;
+	return types[i];
+}
+
+#endif